@@ -0,0 +1,46 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "metric/metricdatabase.h"
+
+namespace metric {
+
+/** @brief Metric database that is defined by a CAN DBC file.
+ *
+ * Each CAN message becomes a group, with the CAN identifier as identity,
+ * and each signal becomes a metric. The unit and comment are the unit and
+ * description of the metric, while the scaling, limits and bit position
+ * are stored as metric properties. The file is memory mapped and the
+ * metrics are created directly from the parsed signals, group by group, so
+ * a large DBC file is loaded without copying it.
+ */
+class DbcDatabase : public MetricDatabase {
+ public:
+  DbcDatabase();
+
+  /** @brief Loads the DBC file when enabled.
+   *
+   * The database is operable if the file was loaded.
+   * @param enable True to load the file.
+   */
+  void Enable(bool enable) override;
+
+  /** @brief Creates the groups and metrics that are defined in the file.
+   *
+   * Existing groups and metrics are kept.
+   * @return False if the file couldn't be opened or parsed.
+   */
+  bool Load();
+
+  /** @brief Returns the line of the last parse error or 0. */
+  [[nodiscard]] size_t ErrorLine() const { return error_line_; }
+
+ private:
+  size_t error_line_ = 0;
+};
+
+}  // namespace metric
@@ -9,34 +9,77 @@
 #include <atomic>
 #include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <span>
+#include <sstream>
+#include <type_traits>
 
 #include "metric/metrictype.h"
+#include "metric/metriccolumns.h"
+#include "metric/metrichandle.h"
+#include "metric/metrichistory.h"
 #include "metric/metricproperty.h"
+#include "metric/metricqueue.h"
+#include "metric/metricsnapshot.h"
+#include "metric/metricvalue.h"
+#include "metric/stringpool.h"
 
 namespace metric {
 
+class MetricGroup;
+
+/** @brief Size of a cache line. Used to avoid false sharing. */
+constexpr size_t kCacheLineSize = 64;
+
 /**
  * @class Metric
  * @brief The Metric class represents a generic value with various properties.
  *
+ * The metric is cache line aligned and its per-sample state is separated
+ * from its metadata, so writers of different metrics, or readers of the
+ * metadata, don't share cache lines with a writer.
  */
  class Metric;
 
-class Metric {
+class alignas(kCacheLineSize) Metric {
  public:
-  Metric() = default;
-  explicit Metric(std::string name);
-  explicit Metric(const std::string_view& name);
-
-  void Name(std::string name);
-  [[nodiscard]] std::string Name() const;
-
-  void GroupName(std::string name);
-  [[nodiscard]] std::string GroupName() const;
-
-  void GroupIdentity(int64_t identity);
-  [[nodiscard]] int64_t GroupIdentity() const;
+  Metric();
+  explicit Metric(std::string_view name);
+
+  /** @brief Creates a metric within a group.
+   *
+   * The name, group name and group identity are the identity of the metric
+   * and can't be changed after creation. The names are interned in the
+   * string pool, which must outlive the metric. They're released when the
+   * metric is destroyed.
+   * @param group_name Group name.
+   * @param group_identity Group identity.
+   * @param name Metric name.
+   * @param pool String pool. The MetricDatabase uses its own pool.
+   */
+  Metric(std::string_view group_name, int64_t group_identity,
+         std::string_view name, StringPool& pool = StringPool::Global());
+
+  /** @brief Moves the identity, properties, value and history.
+   *
+   * Nothing is copied except the scalar value. Views of the names, the
+   * properties and the history stay valid, as they are owned by the new
+   * metric. A metric attached to a column store keeps its row. The source
+   * must not be in use by other threads and not be in an update queue. The
+   * moved-from metric is empty.
+   * @param metric Metric to move from.
+   */
+  Metric(Metric&& metric) noexcept;
+  Metric& operator=(Metric&& metric) noexcept;
+  Metric(const Metric& metric) = delete;
+  Metric& operator=(const Metric& metric) = delete;
+  ~Metric();
+
+  /** @brief Returns the name. The view is valid as long as the metric. */
+  [[nodiscard]] std::string_view Name() const { return name_; }
+  [[nodiscard]] std::string_view GroupName() const { return group_name_; }
+  [[nodiscard]] int64_t GroupIdentity() const { return group_identity_; }
 
   void Identity(uint64_t alias) {
     identity_ = alias;
@@ -45,38 +88,83 @@ class Metric {
     return identity_;
   }
 
-  void Timestamp(uint64_t ms_since_1970) {
-    timestamp_ = ms_since_1970;
+  /** @brief Sets the group whose frame lock the writers of the value take.
+   *
+   * The value, timestamp and valid flag of a metric in a group are written
+   * under the frame lock of the group, so a group read never sees half a
+   * frame. Typical set by MetricGroup::AddMetric(). Waits for the writers
+   * that use the old lock.
+   * @param group Group or nullptr to use the metric lock.
+   */
+  void Group(MetricGroup* group);
+  [[nodiscard]] MetricGroup* Group() const {
+    return group_.load(std::memory_order_acquire);
   }
 
+  /** @brief Sets the database handle. Typical set by the MetricDatabase. */
+  void Handle(MetricHandle handle) { handle_ = handle; }
+  [[nodiscard]] MetricHandle Handle() const { return handle_; }
+
+  void Timestamp(uint64_t ms_since_1970);
+
   [[nodiscard]] uint64_t Timestamp() const {
-    return timestamp_;
+    return TimestampCell();
   }
 
   void Description(std::string desc);
   [[nodiscard]] std::string Description() const;
 
-  void Unit(const std::string& unit);
+  void Unit(std::string unit);
   [[nodiscard]] std::string Unit() const;
 
-  void DataType(MetricType type) {
-    data_type_ = type;
-  }
+  /** @brief Sets the data type of the metric.
+   *
+   * The data type selects how the value is stored. Scalar types are stored
+   * natively while strings and other types are stored as text. An existing
+   * value is converted to the new type.
+   * @param type New data type.
+   */
+  void DataType(MetricType type);
 
   [[nodiscard]] MetricType DataType() const {
-    return data_type_;
+    return Slot().Type();
   }
 
   static std::string_view DataTypeToString(MetricType data_type);
   static MetricType StringToDataType(const std::string& data_type);
 
-  void Historical(bool historical_value) {
-    is_historical_ = historical_value;
-  }
+  /** @brief Defines if the metric should keep a history of its values.
+   *
+   * A historical metric appends each scalar sample together with the
+   * current timestamp to a preallocated ring buffer. Every sample is
+   * stored, also unchanged values and values suppressed by the deadband or
+   * interval filters. Set the timestamp before the value.
+   * @param historical_value True if the metric should store history.
+   */
+  void Historical(bool historical_value);
   [[nodiscard]] bool IsHistorical() const {
     return is_historical_;
   }
 
+  /** @brief Sets the number of samples in the history buffer.
+   *
+   * A new capacity replaces the buffer, so the stored samples are dropped.
+   */
+  void HistoryCapacity(size_t capacity);
+  [[nodiscard]] size_t HistoryCapacity() const {
+    return history_capacity_;
+  }
+
+  /** @brief Returns the history buffer or nullptr if not historical.
+   *
+   * The history samples are stored as the metric's data type. The buffer
+   * is shared with the reader, so it stays valid if the history is
+   * disabled or replaced meanwhile. A replaced buffer gets no new samples.
+   */
+  [[nodiscard]] std::shared_ptr<const MetricHistory> History() const {
+    return history_.load(std::memory_order_acquire);
+  }
+
   void Transient(bool transient_value) {
     is_transient_ = transient_value;
   }
@@ -91,11 +179,17 @@ class Metric {
     return is_null_;
   }
 
+  /** @brief Sets the valid flag. The row is only marked if it changed. */
   void Valid(bool valid) const {
-    valid_ = valid;
+    BeginWrite();
+    const bool old_valid = ValidCell().exchange(valid);
+    EndWrite();
+    if (old_valid != valid) {
+      MarkChanged();
+    }
   }
   [[nodiscard]] bool IsValid() const {
-    return valid_;
+    return ValidCell();
   }
 
   void ReadOnly(bool read_only) {
@@ -105,75 +199,374 @@ class Metric {
     return read_only_;
   }
 
-  void AddProperty(const MetricProperty& property);
-  [[nodiscard]] MetricProperty* CreateProperty(const std::string& key);
-  [[nodiscard]] MetricProperty* GetProperty(const std::string& key);
-  [[nodiscard]] const MetricProperty* GetProperty(const std::string& key) const;
+  /** @brief Adds or replaces a property.
+   *
+   * The property list is immutable once published. A change publishes a
+   * new list, so readers never lock. An old list is freed when the last
+   * reader has released it.
+   * @param property Property to add.
+   */
+  void AddProperty(MetricProperty property);
+
+  /** @brief Returns the property or adds an empty property.
+   *
+   * The property is read-only. Use AddProperty() to change it.
+   * @param key Property key.
+   * @return The property. It keeps its property list alive.
+   */
+  [[nodiscard]] std::shared_ptr<const MetricProperty> CreateProperty(
+      const std::string& key);
+
+  /** @brief Returns the property or nullptr.
+   *
+   * The property keeps its property list alive, so it stays valid when the
+   * metric publishes a new list.
+   * @param key Property key.
+   * @return The property or nullptr.
+   */
+  [[nodiscard]] std::shared_ptr<const MetricProperty> GetProperty(
+      std::string_view key) const;
   void DeleteProperty(const std::string& key);
 
-  const MetricPropertyList& Properties() const {
-    return property_list_;
+  /** @brief Replaces all properties in one publish. */
+  void Properties(MetricPropertyList property_list);
+
+  /** @brief Returns the current property list without locking. */
+  [[nodiscard]] std::shared_ptr<const MetricPropertyList> Properties() const {
+    return property_list_.load(std::memory_order_acquire);
   }
 
+  /** @brief Sets the value of the metric.
+   *
+   * Arithmetic values are converted to the native type of the metric
+   * without any text formatting, so this is a simple store for scalar
+   * metrics. The metric is marked as updated if the value changes.
+   * @tparam T Type of the input value.
+   * @param value New value.
+   */
   template <typename T>
   void Value(T value);
 
+  /** @brief Returns the value of the metric converted to T.
+   *
+   * Requesting a std::string value formats the native value on demand.
+   * @tparam T Requested type.
+   * @return The value of the metric.
+   */
   template<typename T>
   [[nodiscard]] T Value() const;
 
 
-  void SetUpdated() { updated_ = true; }
+  /** @brief Sets the timestamp and a native value in one call.
+   *
+   * This is the same as calling Timestamp() and Value() but without any
+   * template instantiation. It's used by batch updates.
+   * @param timestamp Time in ms since 1970.
+   * @param type Type of the native value.
+   * @param value Native value.
+   * @return True if the value changed.
+   */
+  bool Update(uint64_t timestamp, MetricType type, NativeValue value);
+
+  /** @brief Writes the timestamp and a native value within a group frame.
+   *
+   * The caller holds the frame lock of the metric's group, which is the
+   * writer lock of the metric, see MetricGroup::BeginUpdate(). Scalar
+   * values are written without any other lock. The metric isn't marked or
+   * queued until PublishFrame() is called after the frame.
+   * @param timestamp Frame time in ms since 1970.
+   * @param type Type of the native value.
+   * @param value Native value.
+   * @return True if the value changed.
+   */
+  bool WriteFrame(uint64_t timestamp, MetricType type, NativeValue value);
+
+  /** @brief Marks the row and queues the metric after a frame write. */
+  void PublishFrame();
+
+  /** @brief Reads the native value and its type without conversion. */
+  void Load(MetricType& type, NativeValue& value) const {
+    Slot().Load(type, value);
+  }
+
+  /** @brief Reads the value and the text of string and array values.
+   *
+   * The type, value and text are read together. The text is cleared if
+   * the value is a scalar.
+   * @param type Type of the value.
+   * @param value Native value.
+   * @param text Destination of the text.
+   */
+  void Load(MetricType& type, NativeValue& value, std::string& text) const;
+
+  /** @brief Reads the value, text, timestamp and valid flag of one sample.
+   *
+   * The fields are read under the write sequence of the metric and read
+   * again if a writer changed any of them meanwhile, so they all belong to
+   * the same update.
+   * @param type Type of the value.
+   * @param value Native value.
+   * @param text Destination of the text.
+   * @param timestamp Time of the value in ms since 1970.
+   * @param valid Valid flag of the value.
+   */
+  void Load(MetricType& type, NativeValue& value, std::string& text,
+            uint64_t& timestamp, bool& valid) const;
+
+  /** @brief Sets an absolute deadband for numeric values.
+   *
+   * A new value is suppressed if it differs less or equal to the deadband
+   * from the last accepted value. A suppressed value isn't stored and
+   * doesn't mark the metric as updated. Zero disables the filter.
+   * @param deadband Absolute deadband.
+   */
+  void Deadband(double deadband);
+  [[nodiscard]] double Deadband() const { return deadband_; }
+
+  /** @brief Sets a deadband in percent of the last accepted value.
+   *
+   * @param percent Deadband in percent. Zero disables the filter.
+   */
+  void PercentDeadband(double percent);
+  [[nodiscard]] double PercentDeadband() const { return percent_deadband_; }
+
+  /** @brief Sets the minimum time between two accepted value changes.
+   *
+   * Changes within the interval are suppressed. The interval uses the
+   * metric timestamp or the system time if no timestamp is set.
+   * @param interval Minimum interval in ms. Zero disables the filter.
+   */
+  void MinInterval(uint64_t interval) { min_interval_ = interval; }
+  [[nodiscard]] uint64_t MinInterval() const { return min_interval_; }
+
+  /** @brief Number of value changes that passed the filters. */
+  [[nodiscard]] uint64_t AcceptedUpdates() const { return accepted_updates_; }
+
+  /** @brief Number of value changes that the filters suppressed. */
+  [[nodiscard]] uint64_t SuppressedUpdates() const {
+    return suppressed_updates_;
+  }
+  void ResetUpdateCounters();
+
+  /** @brief Sets the elements of an array metric.
+   *
+   * The elements are copied into a contiguous buffer of the metric's element
+   * type. If T is the element type, the change detection is a memory compare
+   * and the copy a memory copy. Other arithmetic types are converted element
+   * by element. The metric is marked as invalid if it isn't an array type.
+   * @tparam T Arithmetic type or std::string for StringArray metrics.
+   * @param values Array elements.
+   */
+  template <typename T>
+  void Array(std::span<const T> values);
+
+  template <typename T>
+  void Array(const std::vector<T>& values) {
+    Array(std::span<const T>(values));
+  }
+
+  /** @brief Returns a copy of the elements of an array metric.
+   *
+   * The elements are copied under the metric lock, so the result stays
+   * valid while other threads change the array.
+   * @tparam T Element type of the metric or std::string for StringArray.
+   * @return Copy of the elements. Empty if T isn't the element type.
+   */
+  template <typename T>
+  [[nodiscard]] std::vector<T> Array() const;
+
+  /** @brief Copies the elements of an array metric to a list.
+   *
+   * Same as above but the destination's capacity is reused, so a reader
+   * that reuses the destination doesn't allocate in steady state.
+   * @tparam T Element type of the metric or std::string for StringArray.
+   * @param dest Destination list. Cleared but its capacity is reused.
+   * @return Number of elements in the destination list.
+   */
+  template <typename T>
+  size_t CopyArray(std::vector<T>& dest) const;
+
+  /** @brief Returns number of elements in an array metric. */
+  [[nodiscard]] size_t ArraySize() const;
+
+  /** @brief Moves the value, timestamp and valid flag to a column store.
+   *
+   * The metric then becomes a view of its row in the column store. The
+   * current state is copied to the row. Typical the MetricDatabase attaches
+   * its metrics when it's columnar. Attach before the metric is shared
+   * between threads.
+   * @param columns Column store or nullptr to store the state in the metric.
+   * @param row Row in the column store.
+   */
+  void Column(MetricColumns* columns, uint32_t row);
+
+  /** @brief Marks the metric as updated.
+   *
+   * If the metric is attached to an update queue, the metric is pushed to
+   * the queue unless it already is queued.
+   */
+  void SetUpdated();
+
+  /** @brief Attaches the metric to a queue of updated metrics.
+   *
+   * Typical the MetricDatabase attaches its metrics to its update queue.
+   * @param queue Update queue or nullptr to detach.
+   */
+  void Queue(MetricQueue* queue) { queue_ = queue; }
+  [[nodiscard]] MetricQueue* Queue() const { return queue_; }
+
+  /** @brief Attaches the metric to a set of changed rows.
+   *
+   * The metric marks the row of its handle when its value, timestamp or
+   * valid flag is set. Typical the MetricDatabase attaches its metrics when
+   * the first snapshot is taken.
+   * @param change_set Change set or nullptr to detach.
+   */
+  void ChangeSet(MetricChangeSet* change_set) { change_set_ = change_set; }
   void ResetUpdated() { updated_ = false; }
-  [[nodiscard]] bool IsUpdated() {
+
+  /** @brief Returns true if the metric is in an update queue. */
+  [[nodiscard]] bool IsQueued() const {
+    return queued_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] bool IsUpdated() const {
     return updated_;
   }
 
  private:
-  std::string name_;
-  std::string group_name_;
-  int64_t group_identity_;
+  // Cold metadata. Rarely changed after the metric has been configured.
+  // The identity has no setters but isn't const, so the metric is movable.
+  std::string_view name_; ///< Interned name.
+  std::string_view group_name_; ///< Interned group name.
+  StringPool* string_pool_ = nullptr; ///< Pool of the names.
+  int64_t group_identity_ = 0;
   std::atomic<uint64_t> identity_ = 0;
-  std::atomic<uint64_t> timestamp_ = 0;
-  std::atomic<MetricType> data_type_ = MetricType::String;
+  MetricHandle handle_;
+  std::atomic<MetricGroup*> group_ = nullptr; ///< Frame lock or nullptr.
   std::atomic<bool> is_historical_ = false;
   std::atomic<bool> is_transient_ = false;
   std::atomic<bool> is_null_ = false;
-
-  mutable std::atomic<bool> valid_ = false; ///< Indicate if the metric is GOOD or STALE
   std::atomic<bool> read_only_ = false; ///< Indicate if the metric can be changes remotely
 
-  MetricPropertyList property_list_;
+  /** Current property list. Points to a shared empty list until the first
+   * property is added. Readers share the ownership of a list. */
+  std::atomic<std::shared_ptr<const MetricPropertyList>> property_list_;
 
-  mutable std::recursive_mutex metric_mutex_;
-  std::string value_;
+  std::atomic<double> deadband_ = 0.0;
+  std::atomic<double> percent_deadband_ = 0.0;
+  std::atomic<uint64_t> min_interval_ = 0;
 
-  std::atomic<bool> updated_ = false;
+  std::atomic<size_t> history_capacity_ = MetricHistory::kDefaultCapacity;
+  /** Replaced, not cleared, so readers never see a buffer change under
+   * them. Appended by the writer that holds the metric lock. */
+  std::atomic<std::shared_ptr<MetricHistory>> history_;
 
-  std::string GetStringProperty(const std::string& key) const;
-  void SetStringProperty(std::string key, std::string value);
-};
+  friend class MetricQueue;
+  std::atomic<MetricQueue*> queue_ = nullptr;
+  std::atomic<MetricChangeSet*> change_set_ = nullptr;
+  MetricColumns::Chunk* column_ = nullptr; ///< Column store chunk or nullptr.
+  uint32_t column_offset_ = 0; ///< Row within the column chunk.
 
-template<typename T>
-void Metric::Value(T value) {
+  // Hot state, written by each sample. It starts on a new cache line, so
+  // writers don't invalidate the metadata for readers.
 
-  try {
-    bool updated = false;
-    {
-      std::scoped_lock lock(metric_mutex_);
-      std::string new_value = std::to_string(value);
-      if (new_value != value_) {
-        updated = true;
-        value_ = std::move(new_value);
-      }
-    }
-    Valid(true);
-    if (updated) {
-      SetUpdated();
+  /** Serializes the writers. Readers of scalar values don't lock it but
+   * reads the value slot lock-free. */
+  alignas(kCacheLineSize) mutable std::recursive_mutex metric_mutex_;
+  ValueSlot value_slot_; ///< Data type and value of scalar types.
+  std::atomic<uint64_t> timestamp_ = 0;
+  mutable std::atomic<bool> valid_ = false; ///< Indicate if the metric is GOOD or STALE
+  std::atomic<bool> updated_ = false;
+  std::atomic<bool> queued_ = false; ///< True if in the update queue.
+  /** Odd while a writer changes the value, timestamp or valid flag. */
+  mutable std::atomic<uint32_t> write_sequence_ = 0;
+  Metric* next_queued_ = nullptr; ///< Link in the update queue.
+  std::atomic<uint64_t> accepted_updates_ = 0;
+  std::atomic<uint64_t> suppressed_updates_ = 0;
+  /** The filter state of the last accepted value. It isn't reset with
+   * the counters. */
+  bool has_value_ = false;
+  uint64_t last_accepted_time_ = 0;
+
+  std::string text_; ///< Value of string and other non-scalar types.
+  std::vector<uint8_t> array_; ///< Elements of numeric and boolean arrays.
+  std::vector<std::string> string_array_; ///< Elements of string arrays.
+
+  [[nodiscard]] ValueSlot& Slot() {
+    return column_ != nullptr ? column_->value[column_offset_] : value_slot_;
+  }
+  [[nodiscard]] const ValueSlot& Slot() const {
+    return column_ != nullptr ? column_->value[column_offset_] : value_slot_;
+  }
+  [[nodiscard]] std::atomic<uint64_t>& TimestampCell() {
+    return column_ != nullptr ? column_->timestamp[column_offset_]
+                              : timestamp_;
+  }
+  [[nodiscard]] const std::atomic<uint64_t>& TimestampCell() const {
+    return column_ != nullptr ? column_->timestamp[column_offset_]
+                              : timestamp_;
+  }
+  [[nodiscard]] std::atomic<bool>& ValidCell() const {
+    return column_ != nullptr ? column_->valid[column_offset_] : valid_;
+  }
+
+  /** Brackets the writes of a sample. The writers are serialized by the
+   * writer lock, see WriteLock. */
+  void BeginWrite() const {
+    write_sequence_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void EndWrite() const {
+    write_sequence_.fetch_add(1, std::memory_order_release);
+  }
+  void LoadSample(MetricType& type, NativeValue& value, uint64_t& timestamp,
+                  bool& valid) const;
+
+  void MarkChanged() const {
+    if (MetricChangeSet* change_set =
+            change_set_.load(std::memory_order_acquire);
+        change_set != nullptr) {
+      change_set->Mark(handle_.Index());
     }
-  } catch (const std::exception& ) {
-    Valid(false);
   }
 
+  /** @brief Locks the writers of the value, timestamp and valid flag. */
+  class WriteLock;
+
+  /** @brief Marks and queues the metric after a write. */
+  void Notify(bool updated, bool changed);
+
+  std::string GetStringProperty(std::string_view key) const;
+  void SetStringProperty(std::string_view key, std::string value);
+  std::shared_ptr<const MetricPropertyList> PublishPropertiesLocked(
+      MetricPropertyList list);
+
+  bool StoreValue(MetricType type, NativeValue value);
+  bool StoreValueLocked(MetricType type, NativeValue value, bool& changed);
+  void StoreText(std::string_view text);
+  [[nodiscard]] NativeValue LoadValue(MetricType type) const;
+  void StoreArray(MetricType type, const void* data, size_t count);
+  void StoreStringArray(std::span<const std::string> values);
+  [[nodiscard]] const void* ArrayDataLocked(MetricType type,
+                                            size_t& count) const;
+
+  [[nodiscard]] uint64_t SampleTime() const;
+  bool IsFilteredLocked(MetricType data_type, NativeValue old_value,
+                        NativeValue new_value, uint64_t sample_time);
+  bool UpdateLocked(MetricType data_type, NativeValue old_value,
+                    NativeValue new_value);
+  bool StoreArrayLocked(MetricType data_type, MetricType type,
+                        const void* data, size_t count);
+  bool ParseLocked(MetricType data_type, std::string_view text,
+                   bool& updated);
+  [[nodiscard]] std::string TextLocked(MetricType data_type,
+                                       NativeValue value) const;
+};
+
+template<typename T>
+void Metric::Value(T value) {
+  static_assert(std::is_arithmetic_v<T>, "Unsupported value type");
+  StoreValue(TypeOf<T>(), ToNative(value));
 }
 
 template<>
@@ -185,40 +578,59 @@ void Metric::Value(std::string_view value);
 template<>
 void Metric::Value(const char* value);
 
-template<>
-void Metric::Value(bool value);
-
-template<>
-void Metric::Value(float value);
-
-template<>
-void Metric::Value(double value);
-
 template<typename T>
 T Metric::Value() const {
-  T temp = {};
-
-  try {
-    std::lock_guard lock(metric_mutex_);
-    std::istringstream str(value_);
-    str >> temp;
-  } catch (const std::exception& ) {
-    Valid(false);
+  if constexpr (std::is_arithmetic_v<T>) {
+    return FromNative<T>(LoadValue(TypeOf<T>()));
+  } else {
+    T temp = {};
+    try {
+      std::istringstream str(Value<std::string>());
+      str >> temp;
+    } catch (const std::exception& ) {
+      Valid(false);
+    }
+    return temp;
   }
-  return temp;
 }
 
-
 template<>
 std::string Metric::Value() const;
 
-template<>
-int8_t Metric::Value() const;
+template <typename T>
+void Metric::Array(std::span<const T> values) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    StoreStringArray(values);
+  } else {
+    static_assert(std::is_arithmetic_v<T>, "Unsupported element type");
+    StoreArray(TypeOf<T>(), values.data(), values.size());
+  }
+}
 
-template<>
-uint8_t Metric::Value() const;
+template <typename T>
+std::vector<T> Metric::Array() const {
+  std::vector<T> dest;
+  CopyArray(dest);
+  return dest;
+}
 
-template<>
-bool Metric::Value() const;
+template <typename T>
+size_t Metric::CopyArray(std::vector<T>& dest) const {
+  dest.clear();
+  std::scoped_lock lock(metric_mutex_);
+  if constexpr (std::is_same_v<T, std::string>) {
+    if (DataType() == MetricType::StringArray) {
+      dest.assign(string_array_.begin(), string_array_.end());
+    }
+  } else {
+    size_t count = 0;
+    if (const auto* data =
+            static_cast<const T*>(ArrayDataLocked(TypeOf<T>(), count));
+        data != nullptr) {
+      dest.assign(data, data + count);
+    }
+  }
+  return dest.size();
+}
 
 } // end namespace
\ No newline at end of file
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace metric {
+
+class MetricArena;
+
+/** @brief Deleter of objects created in a MetricArena. */
+template <typename T>
+struct ArenaDelete {
+  MetricArena* arena = nullptr;
+  void operator()(T* object) const;
+};
+
+/** @brief Owning pointer to an object in a MetricArena. */
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDelete<T>>;
+
+/** @brief Monotonic memory arena for the objects of a database.
+ *
+ * The objects are packed into a few large buffers instead of being
+ * allocated one by one, so creating and destroying a large schema is a
+ * few allocations and objects created after each other are close in
+ * memory. The memory is released when the arena is destroyed. The block of
+ * a destroyed object is reused by the next object of the same type.
+ *
+ * Containers of the database, typical the index nodes, allocate from the
+ * Resource(). It pools the blocks on top of the arena buffers, so a freed
+ * node is reused by the next node of the same size.
+ *
+ * The arena isn't thread-safe. The owner serializes the access.
+ */
+class MetricArena {
+ public:
+  static constexpr size_t kInitialSize = 64 * 1'024;
+
+  explicit MetricArena(size_t initial_size = kInitialSize);
+  MetricArena(const MetricArena&) = delete;
+  MetricArena& operator=(const MetricArena&) = delete;
+
+  /** @brief Constructs an object in the arena.
+   *
+   * @tparam T Type of object.
+   * @param args Constructor arguments.
+   * @return Owning pointer. The arena must outlive the object.
+   */
+  template <typename T, typename... Args>
+  [[nodiscard]] ArenaPtr<T> Create(Args&&... args);
+
+  /** @brief Destructs an object and keeps its block for reuse. */
+  template <typename T>
+  void Destroy(T* object);
+
+  /** @brief Allocates uninitialized memory for a number of objects.
+   *
+   * The objects are constructed one by one with CreateAt(), so objects
+   * that are created at different times are still next to each other.
+   * Each object is destroyed as a single object, and a block that never
+   * got an object is returned with Release().
+   * @tparam T Type of object.
+   * @param count Number of objects.
+   * @return Pointer to the first block.
+   */
+  template <typename T>
+  [[nodiscard]] T* AllocateArray(size_t count) {
+    return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  /** @brief Constructs an object in a block of AllocateArray(). */
+  template <typename T, typename... Args>
+  [[nodiscard]] ArenaPtr<T> CreateAt(T* block, Args&&... args);
+
+  /** @brief Keeps an unused block of AllocateArray() for reuse. */
+  template <typename T>
+  void Release(T* block) {
+    Deallocate(block, sizeof(T), alignof(T));
+  }
+
+  /** @brief Returns the memory resource for containers of the owner.
+   *
+   * The resource has the same locking as the arena.
+   */
+  [[nodiscard]] std::pmr::memory_resource* Resource() { return &pool_; }
+
+  /** @brief Returns number of bytes taken from the arena buffers. */
+  [[nodiscard]] size_t Allocated() const { return allocated_; }
+
+  /** @brief Returns number of blocks that are free for reuse. */
+  [[nodiscard]] size_t FreeBlocks() const;
+
+ private:
+  std::pmr::monotonic_buffer_resource buffer_;
+  std::pmr::unsynchronized_pool_resource pool_{&buffer_};
+  /** Free blocks by size and alignment. */
+  std::map<std::pair<size_t, size_t>, std::vector<void*>> free_list_;
+  size_t allocated_ = 0;
+
+  [[nodiscard]] void* Allocate(size_t size, size_t alignment);
+  void Deallocate(void* block, size_t size, size_t alignment);
+};
+
+template <typename T>
+void ArenaDelete<T>::operator()(T* object) const {
+  if (arena != nullptr) {
+    arena->Destroy(object);
+  }
+}
+
+template <typename T, typename... Args>
+ArenaPtr<T> MetricArena::Create(Args&&... args) {
+  void* block = Allocate(sizeof(T), alignof(T));
+  T* object = ::new (block) T(std::forward<Args>(args)...);
+  return ArenaPtr<T>(object, ArenaDelete<T>{this});
+}
+
+template <typename T, typename... Args>
+ArenaPtr<T> MetricArena::CreateAt(T* block, Args&&... args) {
+  T* object = ::new (static_cast<void*>(block))
+      T(std::forward<Args>(args)...);
+  return ArenaPtr<T>(object, ArenaDelete<T>{this});
+}
+
+template <typename T>
+void MetricArena::Destroy(T* object) {
+  if (object == nullptr) {
+    return;
+  }
+  std::destroy_at(object);
+  Deallocate(object, sizeof(T), alignof(T));
+}
+
+}  // namespace metric
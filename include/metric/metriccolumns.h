@@ -0,0 +1,98 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "metric/metricvalue.h"
+
+namespace metric {
+
+/** @brief Columnar store of the per-sample state of many metrics.
+ *
+ * The data type and value, timestamp and valid flag are stored in parallel
+ * arrays, one row per metric. A scan of all values is then a sequential
+ * read of a few contiguous arrays instead of a visit of each metric object.
+ *
+ * The rows are allocated in fixed size chunks, so a row never moves when the
+ * store grows. A metric attached to a row keeps a pointer to its chunk.
+ */
+class MetricColumns {
+ public:
+  static constexpr size_t kChunkSize = 4'096;
+  static constexpr size_t kMaxChunks = 4'096; ///< Max 16M rows.
+
+  /** @brief One chunk of rows. Each member is a column. */
+  struct Chunk {
+    std::array<ValueSlot, kChunkSize> value;
+    std::array<std::atomic<uint64_t>, kChunkSize> timestamp = {};
+    std::array<std::atomic<bool>, kChunkSize> valid = {};
+  };
+
+  MetricColumns() = default;
+  MetricColumns(const MetricColumns&) = delete;
+  MetricColumns& operator=(const MetricColumns&) = delete;
+
+  /** @brief Allocates chunks until the row exists.
+   *
+   * Not thread-safe with respect to other calls of Reserve().
+   * @param row Row index.
+   * @return The chunk that holds the row or nullptr if the store is full.
+   */
+  Chunk* Reserve(uint32_t row);
+
+  /** @brief Clears the columns of a row. */
+  void Reset(uint32_t row);
+
+  /** @brief Returns number of allocated rows. */
+  [[nodiscard]] size_t Rows() const {
+    return nof_chunks_.load(std::memory_order_acquire) * kChunkSize;
+  }
+
+  /** @brief Returns the chunk of a row. The row must exist. */
+  [[nodiscard]] Chunk& ChunkOf(uint32_t row) const {
+    return *chunk_list_[row / kChunkSize];
+  }
+  [[nodiscard]] static uint32_t OffsetOf(uint32_t row) {
+    return row % kChunkSize;
+  }
+
+  /** @brief Calls a function for each row.
+   *
+   * The function is called as func(row, type, value, timestamp, valid). The
+   * value and type are read consistently but the scan doesn't block the
+   * writers.
+   * @param func Function to call.
+   */
+  template <typename Func>
+  void ForEach(Func&& func) const;
+
+ private:
+  std::array<std::unique_ptr<Chunk>, kMaxChunks> chunk_list_;
+  std::atomic<size_t> nof_chunks_ = 0;
+};
+
+template <typename Func>
+void MetricColumns::ForEach(Func&& func) const {
+  const size_t nof_chunks = nof_chunks_.load(std::memory_order_acquire);
+  for (size_t chunk_index = 0; chunk_index < nof_chunks; ++chunk_index) {
+    const Chunk& chunk = *chunk_list_[chunk_index];
+    const auto first = static_cast<uint32_t>(chunk_index * kChunkSize);
+    for (uint32_t offset = 0; offset < kChunkSize; ++offset) {
+      MetricType type = MetricType::Unknown;
+      NativeValue value;
+      chunk.value[offset].Load(type, value);
+      func(first + offset, type, value,
+           chunk.timestamp[offset].load(std::memory_order_relaxed),
+           chunk.valid[offset].load(std::memory_order_relaxed));
+    }
+  }
+}
+
+}  // namespace metric
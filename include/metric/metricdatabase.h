@@ -8,10 +8,22 @@
 #include <string>
 #include <string_view>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <vector>
 
 #include "metric/metricgroup.h"
 #include "metric/metric.h"
+#include "metric/metricarena.h"
+#include "metric/metriccolumns.h"
+#include "metric/metricepoch.h"
+#include "metric/metrichandle.h"
+#include "metric/metricindex.h"
+#include "metric/metricmutex.h"
+#include "metric/metricorder.h"
+#include "metric/metricsnapshot.h"
+#include "metric/stringpool.h"
 
 namespace metric {
 
@@ -22,6 +34,40 @@ enum class TypeOfDatabase : int {
   A2lFile = 3,
 };
 
+/** @brief Value update of a metric, used by batch updates.
+ *
+ * The metric is referenced by its handle. The value is stored as a native
+ * value together with its type. A zero timestamp means that the batch time
+ * should be used.
+ */
+struct MetricUpdate {
+  MetricUpdate() = default;
+
+  template <typename T>
+  MetricUpdate(MetricHandle handle, T value, uint64_t timestamp = 0)
+      : handle(handle),
+        type(TypeOf<T>()),
+        value(ToNative(value)),
+        timestamp(timestamp) {
+  }
+
+  MetricHandle handle;
+  MetricType type = MetricType::Unknown;
+  NativeValue value;
+  uint64_t timestamp = 0; ///< Time in ms since 1970 or 0 for batch time.
+};
+
+/** @brief Definition of a metric, used by bulk imports. */
+struct MetricDefinition {
+  std::string group_name;
+  int32_t group_identity = 0;
+  std::string name;
+  MetricType data_type = MetricType::Unknown;
+  std::string unit;
+  std::string description;
+  MetricPropertyList property_list {}; ///< Other properties of the metric.
+};
+
 class MetricDatabase {
  public:
   MetricDatabase() = default;
@@ -46,46 +92,427 @@ class MetricDatabase {
   [[nodiscard]] virtual bool IsEnabled() const {return enabled_; }
   [[nodiscard]] virtual bool IsOperable() const {return operable_; }
 
+  /** @brief Pool of the interned metric and group names. */
+  [[nodiscard]] StringPool& Strings() { return string_pool_; }
+  [[nodiscard]] const StringPool& Strings() const { return string_pool_; }
+
+  /** @brief Makes the database safe to share between threads.
+   *
+   * In concurrent mode, lookups by name, identity or handle may run in
+   * any number of threads while other threads create and delete groups
+   * and metrics. The metric index is split into shards with a reader-writer
+   * lock each, so lookups of different metrics seldom share a lock.
+   * Creates and deletes are serialized with each other. Threads that use
+   * the returned pointers while metrics may be deleted, pin the epoch with
+   * Pin().
+   *
+   * The Groups(), Metrics() and View functions return references to the
+   * containers and are not safe while another thread creates or deletes.
+   * Use the functions that return a copy or the ForEach functions instead.
+   * Change the mode before the database is shared between threads.
+   * @param concurrent True to enable the locks.
+   */
+  void Concurrent(bool concurrent);
+  [[nodiscard]] bool IsConcurrent() const { return list_mutex_.IsEnabled(); }
+
   virtual MetricGroup* CreateGroup(std::string name, int32_t identity);
-  void DeleteGroup(std::string name, uint32_t identity);
 
-  const std::vector<std::unique_ptr<MetricGroup>>& Groups() const {
+  /** @brief Deletes a group. See DeleteMetric() about the reclamation. */
+  void DeleteGroup(std::string_view name, uint32_t identity);
+
+  const std::vector<ArenaPtr<MetricGroup>>& Groups() const {
     return group_list_;
   }
+  /** @brief Returns a copy of the group list, taken under the list lock. */
+  [[nodiscard]] std::vector<MetricGroup*> GroupList() const;
 
-  MetricGroup* GetGroupByName(const std::string& name) const;
+  /** @brief Calls func(MetricGroup&) for each group in list order.
+   *
+   * The list lock is held shared during the calls, so the function must not
+   * create or delete groups or metrics.
+   * @param func Function to call.
+   */
+  template <typename Func>
+  void ForEachGroup(Func&& func) const;
+
+  /** @brief Returns the group with the name.
+   *
+   * The lookup uses a hash index, so the cost doesn't depend on the number
+   * of groups.
+   * @param name Group name.
+   * @return Pointer to the group or nullptr if it doesn't exist.
+   */
+  MetricGroup* GetGroupByName(std::string_view name) const;
   MetricGroup* GetGroupByIdentity(int64_t identity) const;
   void SortGroups();
 
 
   virtual Metric* CreateMetric(const MetricGroup& group, std::string name);
+
+  /** @brief Deletes a metric.
+   *
+   * The metric is immediately removed from the lookups and its handle
+   * becomes invalid, but the memory is only freed when no thread is pinned
+   * to an epoch from before the delete. A thread that pinned the epoch
+   * with Pin() may therefore keep using its metric pointers, so metrics can
+   * be deleted while other threads update values. The last metric in
+   * Metrics() takes the place of the deleted metric.
+   * @param group Group of the metric.
+   * @param name Metric name.
+   */
   void DeleteMetric(const MetricGroup& group, std::string name);
-  const std::vector<std::unique_ptr<Metric>>& Metrics() const {
+
+  /** @brief Pins the current epoch.
+   *
+   * Threads that use metric or group pointers while another thread may
+   * delete them, hold a guard around each unit of work.
+   * @return Guard that unpins the epoch when destroyed.
+   */
+  [[nodiscard]] MetricEpoch::Guard Pin() { return epoch_.Pin(); }
+  [[nodiscard]] MetricEpoch& Epoch() { return epoch_; }
+
+  /** @brief Frees deleted metrics and groups that no thread can use.
+   *
+   * It's called by each delete, so it's only needed to free the memory
+   * earlier.
+   * @return Number of freed metrics and groups.
+   */
+  size_t Reclaim();
+
+  /** @brief Returns number of deleted metrics and groups not yet freed. */
+  [[nodiscard]] size_t Retired() const {
+    std::shared_lock lock(list_mutex_);
+    return retired_metric_list_.size() + retired_group_list_.size();
+  }
+
+  /** @brief Creates groups and metrics from a list of definitions.
+   *
+   * This is the fast path when loading a large schema. The storage is
+   * reserved once and the groups and metrics are created in one pass,
+   * group by group, so the metrics of a group are stored next to each
+   * other.
+   * Definitions of already existing metrics, and duplicates within the
+   * list, are ignored.
+   * @param definition_list List of metric definitions.
+   * @return Number of created metrics.
+   */
+  size_t ImportMetrics(std::span<const MetricDefinition> definition_list);
+
+  /** @brief Creates groups and metrics and moves the definitions.
+   *
+   * Same as above but the unit, description and other properties are moved
+   * into the metric properties instead of being copied.
+   * @param definition_list List of metric definitions.
+   * @return Number of created metrics.
+   */
+  size_t ImportMetrics(std::vector<MetricDefinition>&& definition_list);
+  const std::vector<ArenaPtr<Metric>>& Metrics() const {
     return metric_list_;
   }
+  /** @brief Returns a copy of the metric list, taken under the list lock. */
+  [[nodiscard]] std::vector<Metric*> MetricList() const;
+
+  /** @brief Calls func(Metric&) for each metric in list order.
+   *
+   * The list lock is held shared during the calls, so the function must not
+   * create or delete groups or metrics.
+   * @param func Function to call.
+   */
+  template <typename Func>
+  void ForEachMetric(Func&& func) const;
+
+  /** @brief Calls func(Metric&) for each metric sorted by name.
+   *
+   * Same as walking ViewByName() but under the list lock.
+   */
+  template <typename Func>
+  void ForEachMetricByName(Func&& func) const;
+
+  /** @brief Calls func(Metric&) for each metric sorted by group and name. */
+  template <typename Func>
+  void ForEachMetricByGroup(Func&& func) const;
+
   std::vector<Metric*> MetricsByName() const;
-  std::vector<Metric*> MetricsByGroupName(const std::string& group_name) const;
+  std::vector<Metric*> MetricsByGroupName(std::string_view group_name) const;
   std::vector<Metric*> MetricsByGroupIdentity(int64_t group_identity) const;
 
-  Metric* GetMetricByGroupName(const std::string& group_name,
-                           const std::string& metric_name) const;
+  /** @brief Returns all metrics sorted by name.
+   *
+   * The database keeps sorted indexes that are updated when metrics are
+   * created and deleted, so the range is a view of the index and the cost
+   * is proportional to the number of listed metrics. The range is
+   * invalidated by the next create or delete.
+   * @return Range of metric pointers.
+   */
+  [[nodiscard]] MetricsByNameRange ViewByName() const {
+    return metric_order_.ByName();
+  }
+  [[nodiscard]] MetricsByGroupRange ViewByGroup() const {
+    return metric_order_.ByGroup();
+  }
+  [[nodiscard]] MetricsByGroupRange ViewByGroupName(
+      std::string_view group_name) const {
+    return metric_order_.ByGroupName(group_name);
+  }
+  [[nodiscard]] MetricsByIdentityRange ViewByGroupIdentity(
+      int64_t group_identity) const {
+    return metric_order_.ByGroupIdentity(group_identity);
+  }
+
+  /** @brief Returns a metric by group name and metric name.
+   *
+   * The lookup uses a hash index, so the cost doesn't depend on the number
+   * of metrics and no temporary strings are created.
+   * @param group_name Group name.
+   * @param metric_name Metric name.
+   * @return Pointer to the metric or nullptr if it doesn't exist.
+   */
+  Metric* GetMetricByGroupName(std::string_view group_name,
+                               std::string_view metric_name) const;
   Metric* GetMetricByGroupIdentity(int64_t group_identity,
-                                  const std::string& metric_name) const;
+                                   std::string_view metric_name) const;
+  /** @brief Orders the metric list by group and name.
+   *
+   * The order is copied from the sorted index, so no sorting is done.
+   */
   void SortMetricsByGroup();
   void SortMetricsByName();
+
+  /** @brief Returns the metric that a handle refers to.
+   *
+   * The lookup is an index into a slot table, so it's safe and fast to
+   * cache handles instead of pointers or names. A handle to a deleted
+   * metric returns nullptr, also if its slot has been reused.
+   * @param handle Handle returned by Metric::Handle().
+   * @return Pointer to the metric or nullptr if it doesn't exist.
+   */
+  [[nodiscard]] Metric* GetMetric(MetricHandle handle) const;
+
+  /** @brief Stores the metric values in a column store.
+   *
+   * A columnar database stores the value, timestamp and valid flag of all
+   * metrics in parallel arrays indexed by the handle, and each metric is a
+   * view of its row. A scan of all values with ForEachValue() is then a
+   * sequential read. Change the mode before the metrics are shared between
+   * threads.
+   * @param columnar True to use a column store.
+   */
+  void Columnar(bool columnar);
+  [[nodiscard]] bool IsColumnar() const { return columns_ != nullptr; }
+
+  /** @brief Returns the column store or nullptr if not columnar. */
+  [[nodiscard]] const MetricColumns* Columns() const { return columns_.get(); }
+
+  /** @brief Calls a function for the value of each metric.
+   *
+   * The function is called as func(handle, type, value, timestamp, valid).
+   * A columnar database reads the column store sequentially, otherwise each
+   * metric is read.
+   * @param func Function to call.
+   */
+  template <typename Func>
+  void ForEachValue(Func&& func) const;
+
+  /** @brief Returns an immutable snapshot of all metric values.
+   *
+   * The first call attaches the metrics to a change set and copies all
+   * values. Each later call copies only the pages with metrics that
+   * changed since the previous snapshot and shares the other pages, so the
+   * cost is proportional to the number of changes. If nothing changed, the
+   * previous snapshot is returned. The writers are never blocked and the
+   * readers may keep a snapshot as long as they want. The value, timestamp
+   * and valid flag of a metric are read as one sample, see Metric::Load(),
+   * so they are consistent with each other.
+   *
+   * Snapshots can be taken concurrently with value updates but not with
+   * creation or deletion of metrics, unless the database is concurrent.
+   * @return Shared pointer to the snapshot.
+   */
+  std::shared_ptr<const MetricSnapshot> Snapshot();
+
+  /** @brief Returns the metrics that have been updated since last call.
+   *
+   * Each metric is queued once when it becomes updated, so the cost is
+   * proportional to the number of changed metrics, not the total number of
+   * metrics. The updated flag of the returned metrics are reset. Only one
+   * thread may drain the updates.
+   * @param dest Destination list. Cleared but its capacity is reused.
+   * @return Number of updated metrics.
+   */
+  size_t DrainUpdated(std::vector<Metric*>& dest);
+
+  /** @brief Updates a batch of metric values in one pass.
+   *
+   * Updates without a timestamp get the batch time, so the clock is only
+   * read once per batch. The OnUpdate() function is called once after the
+   * batch if any metric was changed. The epoch is pinned during the batch,
+   * so metrics may be deleted meanwhile. A deleted metric is skipped.
+   * @param update_list List of updates.
+   * @return Number of metrics that changed value.
+   */
+  size_t UpdateBatch(std::span<const MetricUpdate> update_list);
+
+  /** @brief Updates the metrics of a group as one frame.
+   *
+   * All values get the same timestamp and are written under the frame lock
+   * of the group only, so ReadGroup() either sees all or none of them. It's
+   * typical used for a CAN message, where all signals are updated by one
+   * frame. The metrics of a group are created in one memory block, so the
+   * update is a write of a small memory area. The changed metrics are
+   * marked and queued after the frame. Updates of metrics in other groups
+   * are ignored, as are their timestamps.
+   * @param group Group to update.
+   * @param update_list List of updates.
+   * @param timestamp Time in ms since 1970 or 0 for the current time.
+   * @return Number of metrics that changed value.
+   */
+  size_t UpdateGroup(MetricGroup& group,
+                     std::span<const MetricUpdate> update_list,
+                     uint64_t timestamp = 0);
+
+  /** @brief Reads the values of a group as one frame.
+   *
+   * The read is retried if a frame or a value of the group was written
+   * while it was read, so the values are from the same frame. The list lock
+   * is only held while the metrics of the group are listed.
+   * @param group Group to read.
+   * @param dest Destination list, one value per metric in the group.
+   * @return Number of values.
+   */
+  size_t ReadGroup(const MetricGroup& group,
+                   std::vector<SnapshotValue>& dest) const;
+
  protected:
+  /** Declared first, so they are destroyed after the metrics that use them. */
+  StringPool string_pool_;
+  /** Memory of the groups and metrics. */
+  MetricArena arena_;
+  std::unique_ptr<MetricColumns> columns_;
   std::atomic<bool> enabled_ = false;
   std::atomic<bool> operable_ = false;
   TypeOfDatabase type_ = TypeOfDatabase::Unknown;
 
-  std::vector<std::unique_ptr<MetricGroup>> group_list_;
-  std::vector<std::unique_ptr<Metric>> metric_list_;
+  /** Guards the lists, the sorted index, the arena and the retired
+   * objects. Creates and deletes takes it exclusive. */
+  mutable MetricMutex list_mutex_;
+  mutable MetricMutex group_mutex_; ///< Guards the group index.
+  std::vector<ArenaPtr<MetricGroup>> group_list_;
+  std::vector<ArenaPtr<Metric>> metric_list_;
+  /** The index nodes allocate from the arena under the list lock. */
+  GroupIndex group_index_{arena_.Resource()};
+  ShardedMetricIndex metric_index_{arena_.Resource()};
+  MetricOrder metric_order_{arena_.Resource()};
+  MetricQueue update_queue_;
+
+  /** @brief Deleted object that is freed when no thread can use it. */
+  template <typename T>
+  struct RetiredObject {
+    uint64_t epoch = 0;
+    ArenaPtr<T> object;
+  };
+  mutable MetricEpoch epoch_; ///< Also pinned by the const readers.
+  std::vector<RetiredObject<Metric>> retired_metric_list_;
+  std::vector<RetiredObject<MetricGroup>> retired_group_list_;
+
+  std::mutex snapshot_mutex_; ///< Serializes the snapshot builders.
+  std::unique_ptr<MetricChangeSet> change_set_;
+  std::shared_ptr<const MetricSnapshot> snapshot_; ///< Last snapshot.
+
+  HandleTable slot_list_;
+  std::vector<uint32_t> free_slot_list_; ///< Unused slot indexes.
+
+  MetricGroup* AddGroup(std::string name, int32_t identity);
+  Metric* AddMetric(const MetricGroup& group, std::string_view name);
+  /** @brief Same as AddMetric() but the metric isn't added to the sorted
+   * order. The caller adds it with metric_order_.Add() before unlocking. */
+  Metric* AddUnorderedMetric(const MetricGroup& group, std::string_view name);
+  size_t ReclaimRetired();
+  void ReserveMetrics(size_t count);
+  void ReserveGroup(MetricGroup& group, size_t count);
+  void ReleaseGroupBlock(MetricGroup& group);
+  Metric* ImportMetric(const MetricGroup*& group, size_t group_size,
+                       const MetricDefinition& definition, std::string unit,
+                       std::string description,
+                       MetricPropertyList property_list);
+  template <typename Range>
+  void ReorderMetrics(const Range& range);
+  MetricHandle AllocateHandle(Metric& metric);
+  void ReleaseHandle(MetricHandle handle);
+
+  /** @brief Called once after a batch update that changed any metric.
+   *
+   * The default implementation does nothing. A database can override it
+   * to, for example, wake up a publisher thread.
+   * @param nof_changes Number of metrics that changed.
+   */
+  virtual void OnUpdate([[maybe_unused]] size_t nof_changes) {}
  private:
   std::string name_;
   std::string description_;
   std::string filename_;
 };
 
+template <typename Func>
+void MetricDatabase::ForEachGroup(Func&& func) const {
+  std::shared_lock lock(list_mutex_);
+  for (const auto& group : group_list_) {
+    if (group) {
+      func(*group);
+    }
+  }
+}
+
+template <typename Func>
+void MetricDatabase::ForEachMetric(Func&& func) const {
+  std::shared_lock lock(list_mutex_);
+  for (const auto& metric : metric_list_) {
+    if (metric) {
+      func(*metric);
+    }
+  }
+}
+
+template <typename Func>
+void MetricDatabase::ForEachMetricByName(Func&& func) const {
+  std::shared_lock lock(list_mutex_);
+  for (Metric* metric : metric_order_.ByName()) {
+    func(*metric);
+  }
+}
+
+template <typename Func>
+void MetricDatabase::ForEachMetricByGroup(Func&& func) const {
+  std::shared_lock lock(list_mutex_);
+  for (Metric* metric : metric_order_.ByGroup()) {
+    func(*metric);
+  }
+}
+
+template <typename Func>
+void MetricDatabase::ForEachValue(Func&& func) const {
+  if (columns_) {
+    columns_->ForEach([&](uint32_t row, MetricType type, NativeValue value,
+                          uint64_t timestamp, bool valid) {
+      if (row < slot_list_.Size() && slot_list_[row].metric != nullptr) {
+        func(MetricHandle(row, slot_list_[row].generation), type, value,
+             timestamp, valid);
+      }
+    });
+    return;
+  }
+  std::shared_lock lock(list_mutex_);
+  for (const auto& metric : metric_list_) {
+    if (!metric) {
+      continue;
+    }
+    MetricType type = MetricType::Unknown;
+    NativeValue value;
+    metric->Load(type, value);
+    func(metric->Handle(), type, value, metric->Timestamp(),
+         metric->IsValid());
+  }
+}
+
 }  // namespace metric
 
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace metric {
+
+/** @brief Epoch based tracking of readers, used for deferred deletes.
+ *
+ * A thread pins the epoch while it uses objects that another thread may
+ * delete. The deleting thread first unlinks the object, so no new reader
+ * can find it, and then advances the epoch. The object may be freed when
+ * no thread is pinned to the epoch of the delete or an older epoch.
+ *
+ * Pinning and unpinning is lock-free. A guard is cheap, so a thread
+ * should pin around a unit of work, for example a batch of updates, and
+ * not hold the pin while it waits.
+ */
+class MetricEpoch {
+ public:
+  /** @brief Max number of threads that can be pinned at the same time. */
+  static constexpr size_t kMaxReaders = 128;
+
+  /** @brief Pins the current epoch until the guard is destroyed. */
+  class Guard {
+   public:
+    explicit Guard(MetricEpoch& epoch);
+    ~Guard();
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+   private:
+    MetricEpoch& epoch_;
+    size_t slot_ = 0;
+  };
+
+  MetricEpoch() = default;
+  MetricEpoch(const MetricEpoch&) = delete;
+  MetricEpoch& operator=(const MetricEpoch&) = delete;
+
+  [[nodiscard]] Guard Pin() { return Guard(*this); }
+
+  /** @brief Advances the epoch. Called after an object has been unlinked.
+   *
+   * @return Epoch of the unlinked object.
+   */
+  uint64_t Advance() {
+    return epoch_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  /** @brief Returns true if no thread is pinned to the epoch or older.
+   *
+   * @param retire_epoch Epoch returned by Advance().
+   */
+  [[nodiscard]] bool IsSafe(uint64_t retire_epoch) const;
+
+  [[nodiscard]] uint64_t Current() const {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  /** @brief Returns number of pinned threads. */
+  [[nodiscard]] size_t Readers() const;
+
+ private:
+  static constexpr uint64_t kIdle = 0; ///< The epochs starts at 1.
+
+  /** @brief Announced epoch of one reader. */
+  struct alignas(64) ReaderSlot {
+    std::atomic<bool> used = false;
+    std::atomic<uint64_t> epoch = kIdle;
+  };
+
+  std::atomic<uint64_t> epoch_ = 1;
+  std::array<ReaderSlot, kMaxReaders> slot_list_;
+
+  size_t Enter();
+  void Leave(size_t slot);
+};
+
+}  // namespace metric
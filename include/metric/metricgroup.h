@@ -1,10 +1,19 @@
 
+#include <atomic>
 #include <cstdint>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <vector>
+
+#include "metric/stringpool.h"
 
 namespace metric {
 
+class Metric;
+
 enum class TypeOfGroup : int {
   General = 0,
   CanMessage = 1,
@@ -13,11 +22,25 @@ enum class TypeOfGroup : int {
 
 class MetricGroup {
  public:
-  void Name(std::string name) { name_ = std::move(name); }
-  [[nodiscard]] const std::string& Name() const { return name_; }
+  MetricGroup() = default;
+  /** @brief Creates a group that uses the memory of a database.
+   *
+   * The name and description are interned in the string pool, so the name
+   * is shared with the metrics of the group. The metric list allocates
+   * from the resource. Both must outlive the group.
+   * @param pool String pool.
+   * @param resource Memory resource of the metric list.
+   */
+  MetricGroup(StringPool& pool, std::pmr::memory_resource* resource);
+  MetricGroup(const MetricGroup&) = delete;
+  MetricGroup& operator=(const MetricGroup&) = delete;
+  ~MetricGroup();
+
+  void Name(std::string_view name);
+  [[nodiscard]] std::string_view Name() const { return name_; }
 
-  void Description(std::string desc) { description_ = std::move(desc); }
-  [[nodiscard]] const std::string& Description() const { return description_; }
+  void Description(std::string_view desc);
+  [[nodiscard]] std::string_view Description() const { return description_; }
 
   void Type(TypeOfGroup type) { type_ = type; }
   [[nodiscard]] TypeOfGroup Type() const { return type_; }
@@ -25,12 +48,65 @@ class MetricGroup {
   void Identity(int64_t identity) { identity_ = identity; }
   [[nodiscard]] int64_t Identity() const { return identity_; }
 
+  /** @brief Metrics of the group in creation order.
+   *
+   * The list is maintained by the database when metrics are created and
+   * deleted. A metric in the list uses the frame lock of the group, so the
+   * group must outlive its metrics or remove them.
+   */
+  [[nodiscard]] std::span<Metric* const> Metrics() const {
+    return metric_list_;
+  }
+  void AddMetric(Metric& metric);
+  void RemoveMetric(Metric& metric);
+
+  /** @brief Starts an update of the group as one frame.
+   *
+   * The group has a sequence lock, so readers of the frame either see all
+   * or none of the values of an update. Waits if another thread is
+   * updating the group. The lock is also the writer lock of the metrics in
+   * the group, so a single value write never tears a frame.
+   */
+  void BeginUpdate();
+
+  /** @brief Ends the update and publishes the frame timestamp. */
+  void EndUpdate(uint64_t timestamp);
+
+  /** @brief Ends an update that didn't write a new frame. */
+  void EndUpdate();
+
+  /** @brief Returns the sequence to check after a frame has been read.
+   *
+   * Waits while an update is in progress.
+   */
+  [[nodiscard]] uint64_t ReadBegin() const;
+
+  /** @brief Returns true if the frame changed while it was read. */
+  [[nodiscard]] bool ReadRetry(uint64_t sequence) const;
+
+  /** @brief Returns the timestamp of the last frame update. */
+  [[nodiscard]] uint64_t Timestamp() const {
+    return timestamp_.load(std::memory_order_acquire);
+  }
+
  private:
-  std::string name_;
-  std::string description_;
+  StringPool* string_pool_ = &StringPool::Global();
+  std::string_view name_; ///< Interned name.
+  std::string_view description_; ///< Interned description.
   TypeOfGroup type_ = TypeOfGroup::General;
   int64_t identity_ = 0;
 
+  std::pmr::vector<Metric*> metric_list_;
+
+  // The metrics of the group are created in a block of the database arena,
+  // so the values of a frame are next to each other in memory.
+  friend class MetricDatabase;
+  Metric* block_ = nullptr;
+  size_t block_size_ = 0;
+  size_t block_used_ = 0;
+
+  std::atomic<uint64_t> sequence_ = 0; ///< Odd while an update is active.
+  std::atomic<uint64_t> timestamp_ = 0;
 };
 
 }  // namespace metric
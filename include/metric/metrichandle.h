@@ -0,0 +1,102 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace metric {
+
+class Metric;
+
+/** @brief Compact and stable reference to a metric in a MetricDatabase.
+ *
+ * The handle is an index into the database's slot table together with the
+ * generation of the slot. Deleting a metric increments the slot generation,
+ * so an old handle resolves to nullptr instead of to a deleted or reused
+ * metric. A default constructed handle is invalid.
+ */
+class MetricHandle {
+ public:
+  MetricHandle() = default;
+  MetricHandle(uint32_t index, uint32_t generation)
+      : index_(index),
+        generation_(generation) {
+  }
+
+  [[nodiscard]] uint32_t Index() const { return index_; }
+  [[nodiscard]] uint32_t Generation() const { return generation_; }
+
+  /** @brief Returns true if the handle has been issued by a database.
+   *
+   * Note that a valid handle may still refer to a deleted metric.
+   */
+  [[nodiscard]] bool IsValid() const { return generation_ != 0; }
+
+  /** @brief Returns the handle as one 64-bit value. */
+  [[nodiscard]] uint64_t Value() const {
+    return (static_cast<uint64_t>(generation_) << 32) | index_;
+  }
+
+  bool operator==(const MetricHandle&) const = default;
+
+ private:
+  uint32_t index_ = 0;
+  uint32_t generation_ = 0; ///< Zero is an invalid handle.
+};
+
+/** @brief Table of handle slots, indexed by the handle index.
+ *
+ * A slot holds the metric and the current generation of the index. The
+ * slots are allocated in fixed size chunks, so a slot never moves when the
+ * table grows, and a lookup is safe while another thread appends.
+ */
+class HandleTable {
+ public:
+  static constexpr size_t kChunkSize = 4'096;
+  static constexpr size_t kMaxChunks = 4'096; ///< Max 16M handles.
+
+  struct Slot {
+    std::atomic<Metric*> metric = nullptr;
+    std::atomic<uint32_t> generation = 1;
+    /** Index in the owner's metric list. Guarded by the owner. */
+    uint32_t position = 0;
+  };
+
+  HandleTable() = default;
+  HandleTable(const HandleTable&) = delete;
+  HandleTable& operator=(const HandleTable&) = delete;
+
+  /** @brief Returns number of slots. */
+  [[nodiscard]] size_t Size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  /** @brief Returns a slot. The index must be less than Size(). */
+  [[nodiscard]] Slot& operator[](uint32_t index) const {
+    return (*chunk_list_[index / kChunkSize])[index % kChunkSize];
+  }
+
+  /** @brief Appends a slot.
+   *
+   * Not thread-safe with respect to other calls of Append().
+   * @param index Index of the new slot.
+   * @return False if the table is full.
+   */
+  bool Append(uint32_t& index);
+
+  /** @brief Allocates the chunks for a number of slots. */
+  void Reserve(size_t count);
+
+ private:
+  using Chunk = std::array<Slot, kChunkSize>;
+  std::array<std::unique_ptr<Chunk>, kMaxChunks> chunk_list_;
+  std::atomic<size_t> size_ = 0;
+};
+
+}  // namespace metric
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "metric/metricvalue.h"
+
+namespace metric {
+
+/** @brief Historical sample of a metric. */
+struct HistorySample {
+  uint64_t timestamp = 0; ///< Time in ms since 1970.
+  NativeValue value;      ///< Value stored as the metric's data type.
+
+  /** @brief Returns the value converted to T.
+   *
+   * @param type Data type of the metric.
+   * @return The sample value.
+   */
+  template <typename T>
+  [[nodiscard]] T Value(MetricType type) const {
+    return FromNative<T>(ConvertNative(type, TypeOf<T>(), value));
+  }
+};
+
+/** @brief Fixed size ring buffer of historical samples.
+ *
+ * All memory is allocated by the constructor, so appending a sample never
+ * allocates. The newest sample overwrites the oldest when the buffer is full.
+ *
+ * One producer may append while any number of readers reads. Neither the
+ * producer nor the readers take a lock. The timestamps should be appended in
+ * increasing order as the range read uses a binary search.
+ */
+class MetricHistory {
+ public:
+  static constexpr size_t kDefaultCapacity = 1'000;
+
+  explicit MetricHistory(size_t capacity = kDefaultCapacity);
+  MetricHistory(const MetricHistory&) = delete;
+  MetricHistory& operator=(const MetricHistory&) = delete;
+
+  [[nodiscard]] size_t Capacity() const { return capacity_; }
+
+  /** @brief Returns number of samples in the buffer. */
+  [[nodiscard]] size_t Size() const;
+
+  /** @brief Total number of samples that have been appended. */
+  [[nodiscard]] uint64_t Count() const {
+    return count_.load(std::memory_order_acquire);
+  }
+
+  /** @brief Appends a sample. Only one thread may append at a time. */
+  void Append(uint64_t timestamp, NativeValue value);
+
+  /** @brief Removes all samples. Not allowed while appending. */
+  void Clear();
+
+  /** @brief Copies the samples within a time range.
+   *
+   * The destination is cleared but its capacity is reused, so a reader that
+   * reuses the destination doesn't allocate in steady state.
+   * @param from First time (ms since 1970) to include.
+   * @param to Last time (ms since 1970) to include.
+   * @param dest Destination list, sorted on time.
+   * @return Number of samples in the destination list.
+   */
+  size_t Range(uint64_t from, uint64_t to,
+               std::vector<HistorySample>& dest) const;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> timestamp = 0;
+    std::atomic<uint64_t> value = 0;
+  };
+
+  size_t capacity_ = 0;
+  std::unique_ptr<Slot[]> slot_list_;
+  std::atomic<uint64_t> write_count_ = 0; ///< Sample being written + 1.
+  std::atomic<uint64_t> count_ = 0; ///< Number of appended samples.
+
+  [[nodiscard]] uint64_t SlotTime(uint64_t index) const;
+};
+
+}  // namespace metric
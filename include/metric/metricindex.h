@@ -0,0 +1,163 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "metric/metricmutex.h"
+
+namespace metric {
+
+class Metric;
+class MetricGroup;
+
+/** @brief Hash of strings that also accepts string views.
+ *
+ * Together with std::equal_to<>, it enables lookups in unordered
+ * containers without creating a temporary std::string.
+ */
+struct StringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view text) const {
+    return std::hash<std::string_view>{}(text);
+  }
+};
+
+/** @brief Hash indexes of groups by name and by identity.
+ *
+ * The name keys are views of the group's interned name.
+ */
+class GroupIndex {
+ public:
+  explicit GroupIndex(std::pmr::memory_resource* resource =
+                          std::pmr::get_default_resource());
+
+  void Add(MetricGroup& group);
+  void Remove(const MetricGroup& group);
+  void Clear();
+
+  [[nodiscard]] MetricGroup* Find(std::string_view name) const;
+  [[nodiscard]] MetricGroup* Find(int64_t identity) const;
+  [[nodiscard]] MetricGroup* Find(std::string_view name,
+                                  int64_t identity) const;
+
+ private:
+  std::pmr::unordered_multimap<std::string_view, MetricGroup*, StringHash,
+                               std::equal_to<>> name_list_;
+  std::pmr::unordered_multimap<int64_t, MetricGroup*> identity_list_;
+};
+
+/** @brief Hash indexes of metrics by group name or group identity and name.
+ *
+ * The keys are views of the metric's interned names, so the index doesn't
+ * copy any strings. All metrics in the index must use the same string pool,
+ * as the stored keys are compared by address. A lookup by text compares the
+ * characters.
+ */
+class MetricIndex {
+ public:
+  explicit MetricIndex(std::pmr::memory_resource* resource =
+                           std::pmr::get_default_resource());
+
+  void Add(Metric& metric);
+  void Remove(const Metric& metric);
+  void Clear();
+  void Reserve(size_t count);
+
+  [[nodiscard]] Metric* Find(std::string_view group_name,
+                             std::string_view name) const;
+  [[nodiscard]] Metric* Find(int64_t group_identity,
+                             std::string_view name) const;
+  [[nodiscard]] Metric* Find(std::string_view group_name,
+                             int64_t group_identity,
+                             std::string_view name) const;
+
+ private:
+  /** The interned flag is set if the names are from the metric's pool. */
+  struct NameKey {
+    std::string_view group_name;
+    std::string_view name;
+    bool interned = false;
+  };
+  struct IdentityKey {
+    int64_t group_identity = 0;
+    std::string_view name;
+    bool interned = false;
+  };
+
+  struct KeyHash {
+    size_t operator()(const NameKey& key) const;
+    size_t operator()(const IdentityKey& key) const;
+  };
+
+  struct KeyEqual {
+    bool operator()(const NameKey& key1, const NameKey& key2) const;
+    bool operator()(const IdentityKey& key1, const IdentityKey& key2) const;
+  };
+
+  std::pmr::unordered_multimap<NameKey, Metric*, KeyHash, KeyEqual> name_list_;
+  std::pmr::unordered_multimap<IdentityKey, Metric*, KeyHash, KeyEqual>
+      identity_list_;
+};
+
+/** @brief Metric index split into shards with one lock each.
+ *
+ * The shard is selected by the hash of the metric name, which is part of
+ * every lookup key, so a lookup only locks one shard. In concurrent mode,
+ * lookups take a shared lock and adding or removing a metric an exclusive
+ * lock of its shard. Threads that look up different metrics then seldom
+ * touch the same lock.
+ */
+class ShardedMetricIndex {
+ public:
+  static constexpr size_t kShards = 16;
+
+  /** @brief Creates the shards. All shards allocate from the resource.
+   *
+   * The resource is used while a shard is exclusively locked, so it must be
+   * guarded by a lock of the owner when the shards are concurrent.
+   */
+  explicit ShardedMetricIndex(std::pmr::memory_resource* resource =
+                                  std::pmr::get_default_resource());
+
+  /** @brief Enables the shard locks. Change it before sharing the index. */
+  void Concurrent(bool concurrent);
+
+  void Add(Metric& metric);
+  void Remove(const Metric& metric);
+  void Clear();
+  void Reserve(size_t count);
+
+  [[nodiscard]] Metric* Find(std::string_view group_name,
+                             std::string_view name) const;
+  [[nodiscard]] Metric* Find(int64_t group_identity,
+                             std::string_view name) const;
+  [[nodiscard]] Metric* Find(std::string_view group_name,
+                             int64_t group_identity,
+                             std::string_view name) const;
+
+ private:
+  /** Aligned, so the locks of two shards don't share a cache line. */
+  struct alignas(64) Shard {
+    mutable MetricMutex mutex;
+    MetricIndex index;
+  };
+  std::array<Shard, kShards> shard_list_;
+
+  template <size_t... Index>
+  [[nodiscard]] static std::array<Shard, kShards> MakeShards(
+      std::pmr::memory_resource* resource, std::index_sequence<Index...>);
+  [[nodiscard]] static size_t ShardIndex(std::string_view name);
+};
+
+}  // namespace metric
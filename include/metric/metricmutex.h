@@ -0,0 +1,57 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <shared_mutex>
+
+namespace metric {
+
+/** @brief Reader-writer mutex that only locks when it is enabled.
+ *
+ * A database that isn't shared between threads shouldn't pay for its
+ * locks, so the locks are enabled by the concurrent mode. It can be used
+ * with std::shared_lock, std::unique_lock and std::scoped_lock. The mode
+ * must not be changed while the mutex is locked.
+ */
+class MetricMutex {
+ public:
+  MetricMutex() = default;
+  MetricMutex(const MetricMutex&) = delete;
+  MetricMutex& operator=(const MetricMutex&) = delete;
+
+  void Enable(bool enable) { enabled_ = enable; }
+  [[nodiscard]] bool IsEnabled() const { return enabled_; }
+
+  void lock() {
+    if (enabled_) {
+      mutex_.lock();
+    }
+  }
+  bool try_lock() { return !enabled_ || mutex_.try_lock(); }
+  void unlock() {
+    if (enabled_) {
+      mutex_.unlock();
+    }
+  }
+
+  void lock_shared() {
+    if (enabled_) {
+      mutex_.lock_shared();
+    }
+  }
+  bool try_lock_shared() { return !enabled_ || mutex_.try_lock_shared(); }
+  void unlock_shared() {
+    if (enabled_) {
+      mutex_.unlock_shared();
+    }
+  }
+
+ private:
+  std::shared_mutex mutex_;
+  bool enabled_ = false;
+};
+
+}  // namespace metric
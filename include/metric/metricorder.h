@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <ranges>
+#include <set>
+#include <span>
+#include <string_view>
+
+namespace metric {
+
+class Metric;
+
+/** @brief Sorted indexes of metrics by name and by group and name.
+ *
+ * The indexes are updated when a metric is added or removed, so a sorted
+ * listing is a walk of a tree instead of a sort. The ranges are views into
+ * the index and are invalidated by the next add or remove. Metrics with
+ * equal keys are ordered by address. The tree nodes allocate from the
+ * memory resource given at construction.
+ */
+class MetricOrder {
+ public:
+  explicit MetricOrder(std::pmr::memory_resource* resource =
+                           std::pmr::get_default_resource());
+
+  /** @brief Ordered by group name, group identity and name. */
+  struct GroupLess {
+    using is_transparent = void;
+    bool operator()(const Metric* metric1, const Metric* metric2) const;
+    bool operator()(const Metric* metric, std::string_view group_name) const;
+    bool operator()(std::string_view group_name, const Metric* metric) const;
+  };
+
+  /** @brief Ordered by group identity and name. */
+  struct IdentityLess {
+    using is_transparent = void;
+    bool operator()(const Metric* metric1, const Metric* metric2) const;
+    bool operator()(const Metric* metric, int64_t group_identity) const;
+    bool operator()(int64_t group_identity, const Metric* metric) const;
+  };
+
+  /** @brief Ordered by name. */
+  struct NameLess {
+    bool operator()(const Metric* metric1, const Metric* metric2) const;
+  };
+
+  template <typename Less>
+  using Range =
+      std::ranges::subrange<typename std::pmr::set<Metric*, Less>::const_iterator>;
+
+  void Add(Metric& metric);
+
+  /** @brief Adds the new metrics of one group.
+   *
+   * The list is sorted and each metric is inserted next to the previous,
+   * so only the first metric is searched for in the group orders. Use it
+   * when many metrics are created at once.
+   * @param metric_list Metrics with the same group name and identity.
+   */
+  void Add(std::span<Metric*> metric_list);
+  void Remove(Metric& metric);
+  void Clear();
+  [[nodiscard]] size_t Size() const { return name_list_.size(); }
+
+  /** @brief Returns all metrics sorted by name. */
+  [[nodiscard]] Range<NameLess> ByName() const { return name_list_; }
+
+  /** @brief Returns all metrics sorted by group and name. */
+  [[nodiscard]] Range<GroupLess> ByGroup() const { return group_list_; }
+
+  /** @brief Returns the metrics of a group name sorted by name.
+   *
+   * If several groups have the same name, their metrics are ordered by
+   * group identity first.
+   */
+  [[nodiscard]] Range<GroupLess> ByGroupName(
+      std::string_view group_name) const;
+
+  /** @brief Returns the metrics of a group identity sorted by name. */
+  [[nodiscard]] Range<IdentityLess> ByGroupIdentity(
+      int64_t group_identity) const;
+
+ private:
+  std::pmr::set<Metric*, NameLess> name_list_;
+  std::pmr::set<Metric*, GroupLess> group_list_;
+  std::pmr::set<Metric*, IdentityLess> identity_list_;
+};
+
+/** @brief Sorted view of metrics in a MetricDatabase. */
+using MetricsByNameRange = MetricOrder::Range<MetricOrder::NameLess>;
+using MetricsByGroupRange = MetricOrder::Range<MetricOrder::GroupLess>;
+using MetricsByIdentityRange = MetricOrder::Range<MetricOrder::IdentityLess>;
+
+}  // namespace metric
@@ -6,33 +6,94 @@
 #pragma once
 
 #include <string>
-#include <mutex>
+#include <string_view>
 #include <sstream>
-#include <map>
 #include <vector>
 #include <memory>
+#include <type_traits>
 
 #include "metric/metrictype.h"
+#include "metric/metricvalue.h"
+#include "metric/stringpool.h"
 
 
 namespace metric {
 
 class MetricProperty;
 
-using MetricPropertyList = std::map<std::string, MetricProperty>;
+/** @brief Flat list of properties sorted on key.
+ *
+ * The properties are stored in one contiguous array, sorted on their key,
+ * so a lookup is a binary search without any allocation. The key to find
+ * doesn't need to be interned.
+ */
+class MetricPropertyList {
+ public:
+  using iterator = std::vector<MetricProperty>::iterator;
+  using const_iterator = std::vector<MetricProperty>::const_iterator;
+
+  /** @brief Returns the property with the key or nullptr. */
+  [[nodiscard]] MetricProperty* Find(std::string_view key);
+  [[nodiscard]] const MetricProperty* Find(std::string_view key) const;
+
+  /** @brief Adds a property or replaces the property with the same key.
+   *
+   * @param property Property to add.
+   * @return Reference to the stored property.
+   */
+  MetricProperty& Insert(MetricProperty property);
+
+  /** @brief Removes the property with the key.
+   *
+   * @param key Property key.
+   * @return True if the property existed.
+   */
+  bool Erase(std::string_view key);
+
+  void Reserve(size_t count);
+
+  [[nodiscard]] size_t size() const { return list_.size(); }
+  [[nodiscard]] bool empty() const { return list_.empty(); }
+  [[nodiscard]] iterator begin() { return list_.begin(); }
+  [[nodiscard]] iterator end() { return list_.end(); }
+  [[nodiscard]] const_iterator begin() const { return list_.cbegin(); }
+  [[nodiscard]] const_iterator end() const { return list_.cend(); }
+
+ private:
+  std::vector<MetricProperty> list_;
+  [[nodiscard]] size_t LowerBound(std::string_view key) const;
+};
 
+/** @brief Key and value pair with an optional array of property lists.
+ *
+ * The property has no lock. The owner of the property, typical a metric,
+ * synchronizes the access. A copy is a deep copy, including the property
+ * array. A move transfers the value and the property array without any
+ * allocation, as the key is an interned view. The property holds a
+ * reference to its key in the global string pool.
+ *
+ * A number of the same type as the property is stored as a native value
+ * and only formatted when it is read as text. Other values are stored as
+ * text. The property array is allocated on first use, so a plain property
+ * is one cache line.
+ */
 class MetricProperty {
  public:
-  MetricProperty() = default;
-  MetricProperty(std::string key, std::string value);
+  MetricProperty();
+  MetricProperty(std::string_view key, std::string value);
 
   MetricProperty(const MetricProperty& property);
-  MetricProperty& operator = (const MetricProperty& property);
+  MetricProperty(MetricProperty&& property) noexcept;
+  MetricProperty& operator=(const MetricProperty& property);
+  MetricProperty& operator=(MetricProperty&& property) noexcept;
+  ~MetricProperty();
 
-  void Key(const std::string& key) { key_ = key;}
-  [[nodiscard]] const std::string& Key() const { return key_;}
+  /** @brief Sets the key. The key is interned in the global string pool. */
+  void Key(std::string_view key);
+  [[nodiscard]] std::string_view Key() const { return key_;}
 
-  void DataType(MetricType type) { type_ = type;}
+  /** @brief Sets the type. A native value of another type becomes text. */
+  void DataType(MetricType type);
   [[nodiscard]] MetricType DataType() const { return type_;}
 
   void Null(bool is_null);
@@ -48,23 +109,31 @@ class MetricProperty {
   const std::vector<MetricPropertyList>& PropertyArray() const;
 
  private:
-  std::string key_;
+  std::string_view key_; ///< Interned key.
   MetricType  type_ = MetricType::String;
   bool        is_null_ = false;
-  std::string value_;
-
-  std::vector< MetricPropertyList > prop_array_;
-
-  mutable std::recursive_mutex property_mutex_;
+  bool        is_native_ = false; ///< The value is in native_.
+  union {
+    std::string value_ = {}; ///< Text value.
+    NativeValue native_; ///< Number of the property type.
+  };
+
+  std::unique_ptr<std::vector<MetricPropertyList>> prop_array_;
+
+  void StoreValue(MetricType type, NativeValue value);
+  [[nodiscard]] NativeValue LoadValue(MetricType type) const;
+  /** Returns the text value, which becomes the stored value. */
+  [[nodiscard]] std::string& TextValue();
+  void StoreNative(NativeValue value);
+  [[nodiscard]] std::unique_ptr<std::vector<MetricPropertyList>> CopyArray()
+      const;
 };
 
 
 template<typename T>
 void MetricProperty::Value(T value) {
-  try {
-    std::scoped_lock lock(property_mutex_);
-    value_ = std::to_string(value);
-  } catch (const std::exception&) {}
+  static_assert(std::is_arithmetic_v<T>, "Unsupported value type");
+  StoreValue(TypeOf<T>(), ToNative(value));
 }
 
 template<>
@@ -76,37 +145,23 @@ void MetricProperty::Value(std::string_view value);
 template<>
 void MetricProperty::Value(const char* value);
 
-template<>
-void MetricProperty::Value(bool value);
-
-template<>
-void MetricProperty::Value(float value);
-
-template<>
-void MetricProperty::Value(double value);
-
 template <typename T>
 [[nodiscard]] T MetricProperty::Value() const {
-  T temp = {};
-  try {
-    std::istringstream str(value_);
-    str >> temp;
-  } catch (const std::exception& ) {
+  if constexpr (std::is_arithmetic_v<T>) {
+    return FromNative<T>(LoadValue(TypeOf<T>()));
+  } else {
+    T temp = {};
+    try {
+      std::istringstream str(Value<std::string>());
+      str >> temp;
+    } catch (const std::exception& ) {
+    }
+    return temp;
   }
-  return temp;
 }
 
 template<>
 [[nodiscard]] std::string  MetricProperty::Value() const;
-
-template<>
-[[nodiscard]] int8_t  MetricProperty::Value() const;
-
-template<>
-[[nodiscard]] uint8_t  MetricProperty::Value() const;
-
-template<>
-[[nodiscard]] bool MetricProperty::Value() const;
 } // pub_sub
 
 
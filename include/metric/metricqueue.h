@@ -0,0 +1,66 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace metric {
+
+class Metric;
+
+/** @brief Queue of updated metrics.
+ *
+ * The queue is intrusive, i.e. the link is stored in the metric itself, so
+ * pushing never allocates. A metric is pushed once when it becomes updated
+ * and isn't pushed again until the consumer has drained it.
+ *
+ * Any number of threads may push (lock-free) while one consumer drains. A
+ * deleted metric is detached from the queue instead of being unlinked, and
+ * the consumer drops it. The consumer side has a lock, so the owner can
+ * purge the detached metrics without a running consumer.
+ */
+class MetricQueue {
+ public:
+  MetricQueue() = default;
+  MetricQueue(const MetricQueue&) = delete;
+  MetricQueue& operator=(const MetricQueue&) = delete;
+
+  /** @brief Pushes a metric if it isn't already queued. */
+  void Push(Metric& metric);
+
+  /** @brief Moves all queued metrics to the destination list.
+   *
+   * The metrics are returned in the order they were pushed and their
+   * updated flag is reset. Metrics that have been detached from the queue
+   * are dropped. Only one thread may drain at a time.
+   * @param dest Destination list. Cleared but its capacity is reused.
+   * @return Number of metrics in the destination list.
+   */
+  size_t Drain(std::vector<Metric*>& dest);
+
+  /** @brief Drops the metrics that have been detached from the queue.
+   *
+   * The other metrics are kept in push order for the next Drain(), so the
+   * order isn't changed. A dropped metric isn't accessed by the queue
+   * anymore.
+   */
+  void Purge();
+
+  [[nodiscard]] bool IsEmpty() const;
+
+ private:
+  std::atomic<Metric*> head_ = nullptr;
+
+  mutable std::mutex consumer_mutex_;
+  /** Taken metrics in push order, not yet drained. */
+  std::vector<Metric*> pending_list_;
+
+  void TakeAllLocked();
+};
+
+}  // namespace metric
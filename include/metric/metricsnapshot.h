@@ -0,0 +1,228 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "metric/metrichandle.h"
+#include "metric/metricvalue.h"
+
+namespace metric {
+
+/** @brief Set of changed rows, one bit per metric handle index.
+ *
+ * A metric attached to a change set marks its row when its value,
+ * timestamp or valid flag changes. Marking is lock-free and a row that
+ * already is marked is only read. The bits are stored in fixed size chunks,
+ * so a bit never moves when the set grows.
+ */
+class MetricChangeSet {
+ public:
+  static constexpr size_t kChunkSize = 4'096; ///< Rows per chunk.
+  static constexpr size_t kMaxChunks = 4'096;
+
+  MetricChangeSet() = default;
+  MetricChangeSet(const MetricChangeSet&) = delete;
+  MetricChangeSet& operator=(const MetricChangeSet&) = delete;
+
+  /** @brief Allocates chunks until the row exists.
+   *
+   * Not thread-safe with respect to other calls of Reserve().
+   * @param row Row index.
+   * @return False if the set is full.
+   */
+  bool Reserve(uint32_t row);
+
+  /** @brief Marks a row as changed. Rows that don't exist are ignored. */
+  void Mark(uint32_t row) {
+    const size_t chunk_index = row / kChunkSize;
+    if (chunk_index >= nof_chunks_.load(std::memory_order_acquire)) {
+      return;
+    }
+    const size_t offset = row % kChunkSize;
+    std::atomic<uint64_t>& word = (*chunk_list_[chunk_index])[offset / 64];
+    const uint64_t bit = uint64_t{1} << (offset % 64);
+    if ((word.load(std::memory_order_relaxed) & bit) == 0) {
+      word.fetch_or(bit, std::memory_order_release);
+    }
+  }
+
+  /** @brief Clears the marked rows and calls a function for each of them.
+   *
+   * The function is called as func(row). The cost is one read per 64 rows
+   * plus the number of marked rows. Only one thread may drain the set.
+   * @param func Function to call.
+   * @return Number of marked rows.
+   */
+  template <typename Func>
+  size_t Drain(Func&& func);
+
+ private:
+  using Chunk = std::array<std::atomic<uint64_t>, kChunkSize / 64>;
+  std::array<std::unique_ptr<Chunk>, kMaxChunks> chunk_list_;
+  std::atomic<size_t> nof_chunks_ = 0;
+};
+
+/** @brief Value, timestamp and valid flag of a metric in a snapshot. */
+struct SnapshotValue {
+  MetricHandle handle; ///< Invalid if the row has no metric.
+  MetricType type = MetricType::Unknown;
+  NativeValue value;
+  /** Text of string and array values, as Metric::Value<std::string>().
+   * Unchanged texts are shared between snapshots. Null for scalars. */
+  std::shared_ptr<const std::string> text;
+  uint64_t timestamp = 0;
+  bool valid = false;
+
+  /** @brief Returns the value as text. */
+  [[nodiscard]] std::string Text() const;
+};
+
+/** @brief Immutable view of the values of all metrics in a database.
+ *
+ * The values are stored in pages of rows indexed by the metric handle. The
+ * pages are referenced from chunks of a page table. A new snapshot shares
+ * the unchanged pages and chunks with the previous snapshot and only copies
+ * the pages and chunks with changed rows, so the cost of a new snapshot is
+ * proportional to the number of changes. A snapshot never changes after it
+ * has been published, so any number of threads may read it without locks.
+ * It's released when the last reader drops it.
+ */
+class MetricSnapshot {
+ public:
+  static constexpr size_t kPageSize = 64; ///< Rows per page.
+  static constexpr size_t kChunkSize = 64; ///< Pages per page table chunk.
+  using Page = std::array<SnapshotValue, kPageSize>;
+  using PageChunk = std::array<std::shared_ptr<const Page>, kChunkSize>;
+
+  /** @brief Returns the version. A new version means that a value changed. */
+  [[nodiscard]] uint64_t Version() const { return version_; }
+
+  /** @brief Returns number of rows. Some rows may be empty. */
+  [[nodiscard]] size_t Rows() const { return nof_pages_ * kPageSize; }
+
+  /** @brief Returns the value of a metric.
+   *
+   * @param handle Metric handle.
+   * @return Pointer to the value or nullptr if the metric didn't exist when
+   * the snapshot was taken.
+   */
+  [[nodiscard]] const SnapshotValue* Get(MetricHandle handle) const;
+
+  /** @brief Returns true if both snapshots share the page of a row. */
+  [[nodiscard]] bool IsShared(const MetricSnapshot& snapshot,
+                              uint32_t row) const;
+
+  /** @brief Calls func(const SnapshotValue&) for each metric. */
+  template <typename Func>
+  void ForEach(Func&& func) const;
+
+  /** @brief Calls func(const SnapshotValue&) for each changed metric.
+   *
+   * Only the pages that aren't shared with the previous snapshot are
+   * compared, so the cost is proportional to the number of changes.
+   * @param previous Previous snapshot or nullptr to report all metrics.
+   * @param func Function to call.
+   */
+  template <typename Func>
+  void ForEachChanged(const MetricSnapshot* previous, Func&& func) const;
+
+ private:
+  friend class MetricDatabase;
+  uint64_t version_ = 0;
+  size_t nof_pages_ = 0;
+  /** Chunks of the page table. A null page has no metrics. */
+  std::vector<std::shared_ptr<const PageChunk>> chunk_list_;
+
+  [[nodiscard]] const PageChunk* ChunkOf(size_t page_index) const {
+    return page_index < nof_pages_ ? chunk_list_[page_index / kChunkSize].get()
+                                   : nullptr;
+  }
+  [[nodiscard]] const Page* PageOf(size_t page_index) const {
+    const PageChunk* chunk = ChunkOf(page_index);
+    return chunk != nullptr ? (*chunk)[page_index % kChunkSize].get()
+                            : nullptr;
+  }
+  [[nodiscard]] static bool IsSameValue(const SnapshotValue& item1,
+                                        const SnapshotValue& item2);
+};
+
+template <typename Func>
+size_t MetricChangeSet::Drain(Func&& func) {
+  size_t count = 0;
+  const size_t nof_chunks = nof_chunks_.load(std::memory_order_acquire);
+  for (size_t chunk_index = 0; chunk_index < nof_chunks; ++chunk_index) {
+    Chunk& chunk = *chunk_list_[chunk_index];
+    for (size_t word_index = 0; word_index < chunk.size(); ++word_index) {
+      if (chunk[word_index].load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      uint64_t bits = chunk[word_index].exchange(0, std::memory_order_acq_rel);
+      while (bits != 0) {
+        const auto bit = static_cast<size_t>(std::countr_zero(bits));
+        bits &= bits - 1;
+        func(static_cast<uint32_t>(chunk_index * kChunkSize +
+                                   word_index * 64 + bit));
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+template <typename Func>
+void MetricSnapshot::ForEach(Func&& func) const {
+  for (size_t page_index = 0; page_index < nof_pages_; ++page_index) {
+    const Page* page = PageOf(page_index);
+    if (page == nullptr) {
+      continue;
+    }
+    for (const SnapshotValue& item : *page) {
+      if (item.handle.IsValid()) {
+        func(item);
+      }
+    }
+  }
+}
+
+template <typename Func>
+void MetricSnapshot::ForEachChanged(const MetricSnapshot* previous,
+                                    Func&& func) const {
+  for (size_t page_index = 0; page_index < nof_pages_; ++page_index) {
+    const PageChunk* old_chunk =
+        previous != nullptr ? previous->ChunkOf(page_index) : nullptr;
+    if (old_chunk != nullptr && old_chunk == ChunkOf(page_index)) {
+      // The whole chunk is shared. Skip to the next chunk.
+      page_index += kChunkSize - 1 - page_index % kChunkSize;
+      continue;
+    }
+    const Page* old_page =
+        old_chunk != nullptr ? (*old_chunk)[page_index % kChunkSize].get()
+                             : nullptr;
+    const Page* page = PageOf(page_index);
+    if (page == nullptr || old_page == page) {
+      continue;
+    }
+    for (size_t offset = 0; offset < kPageSize; ++offset) {
+      const SnapshotValue& item = (*page)[offset];
+      if (!item.handle.IsValid()) {
+        continue;
+      }
+      if (old_page != nullptr && IsSameValue((*old_page)[offset], item)) {
+        continue;
+      }
+      func(item);
+    }
+  }
+}
+
+}  // namespace metric
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "metric/metrictype.h"
+
+namespace metric {
+
+/** @brief Defines how a value of a specific metric type is stored.
+ *
+ * Scalar types are stored natively in a NativeValue and array types are
+ * stored in a contiguous buffer of native elements. The remaining types
+ * (String, Text, UUID...) are stored as text.
+ */
+enum class ValueKind : uint8_t {
+  Text = 0,  ///< Stored as text.
+  Signed,    ///< Stored as a 64-bit signed integer.
+  Unsigned,  ///< Stored as a 64-bit unsigned integer.
+  Float,     ///< Stored as a 32-bit float.
+  Double,    ///< Stored as a 64-bit float.
+  Boolean,   ///< Stored as a boolean.
+  Array,     ///< Stored as an array of elements.
+};
+
+/** @brief Returns the storage kind of a metric type. */
+constexpr ValueKind KindOf(MetricType type) {
+  switch (type) {
+    case MetricType::Int8:
+    case MetricType::Int16:
+    case MetricType::Int32:
+    case MetricType::Int64:
+      return ValueKind::Signed;
+
+    case MetricType::UInt8:
+    case MetricType::UInt16:
+    case MetricType::UInt32:
+    case MetricType::UInt64:
+    case MetricType::DateTime:
+      return ValueKind::Unsigned;
+
+    case MetricType::Float:
+      return ValueKind::Float;
+
+    case MetricType::Double:
+      return ValueKind::Double;
+
+    case MetricType::Boolean:
+      return ValueKind::Boolean;
+
+    case MetricType::Int8Array:
+    case MetricType::Int16Array:
+    case MetricType::Int32Array:
+    case MetricType::Int64Array:
+    case MetricType::UInt8Array:
+    case MetricType::UInt16Array:
+    case MetricType::UInt32Array:
+    case MetricType::UInt64Array:
+    case MetricType::FloatArray:
+    case MetricType::DoubleArray:
+    case MetricType::BooleanArray:
+    case MetricType::StringArray:
+    case MetricType::DateTimeArray:
+      return ValueKind::Array;
+
+    default:
+      break;
+  }
+  return ValueKind::Text;
+}
+
+/** @brief Returns true if the type is stored as a single native value. */
+constexpr bool IsScalar(MetricType type) {
+  const ValueKind kind = KindOf(type);
+  return kind != ValueKind::Text && kind != ValueKind::Array;
+}
+
+/** @brief Returns the element type of an array type.
+ *
+ * @param type Array type.
+ * @return The element type or Unknown if the type isn't an array.
+ */
+constexpr MetricType ElementTypeOf(MetricType type) {
+  switch (type) {
+    case MetricType::Int8Array: return MetricType::Int8;
+    case MetricType::Int16Array: return MetricType::Int16;
+    case MetricType::Int32Array: return MetricType::Int32;
+    case MetricType::Int64Array: return MetricType::Int64;
+    case MetricType::UInt8Array: return MetricType::UInt8;
+    case MetricType::UInt16Array: return MetricType::UInt16;
+    case MetricType::UInt32Array: return MetricType::UInt32;
+    case MetricType::UInt64Array: return MetricType::UInt64;
+    case MetricType::FloatArray: return MetricType::Float;
+    case MetricType::DoubleArray: return MetricType::Double;
+    case MetricType::BooleanArray: return MetricType::Boolean;
+    case MetricType::StringArray: return MetricType::String;
+    case MetricType::DateTimeArray: return MetricType::DateTime;
+    default: break;
+  }
+  return MetricType::Unknown;
+}
+
+/** @brief Returns the size in bytes of a scalar type as array element.
+ *
+ * @param type Scalar type.
+ * @return Number of bytes or 0 if the type isn't a scalar.
+ */
+constexpr size_t SizeOf(MetricType type) {
+  switch (type) {
+    case MetricType::Int8:
+    case MetricType::UInt8:
+    case MetricType::Boolean:
+      return 1;
+
+    case MetricType::Int16:
+    case MetricType::UInt16:
+      return 2;
+
+    case MetricType::Int32:
+    case MetricType::UInt32:
+    case MetricType::Float:
+      return 4;
+
+    case MetricType::Int64:
+    case MetricType::UInt64:
+    case MetricType::Double:
+    case MetricType::DateTime:
+      return 8;
+
+    default:
+      break;
+  }
+  return 0;
+}
+
+/** @brief Returns the metric type that matches a C++ arithmetic type. */
+template <typename T>
+constexpr MetricType TypeOf() {
+  static_assert(std::is_arithmetic_v<T>, "Only arithmetic types are native");
+  if constexpr (std::is_same_v<T, bool>) {
+    return MetricType::Boolean;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return sizeof(T) <= sizeof(float) ? MetricType::Float : MetricType::Double;
+  } else if constexpr (std::is_signed_v<T>) {
+    switch (sizeof(T)) {
+      case 1: return MetricType::Int8;
+      case 2: return MetricType::Int16;
+      case 4: return MetricType::Int32;
+      default: return MetricType::Int64;
+    }
+  } else {
+    switch (sizeof(T)) {
+      case 1: return MetricType::UInt8;
+      case 2: return MetricType::UInt16;
+      case 4: return MetricType::UInt32;
+      default: return MetricType::UInt64;
+    }
+  }
+}
+
+/** @brief Native storage of a scalar value.
+ *
+ * The union doesn't know its active member. It is always used together with
+ * a MetricType (the tag) that selects the member through KindOf().
+ * A default constructed value is all zeros.
+ */
+union NativeValue {
+  int64_t signed_value = 0;
+  uint64_t unsigned_value;
+  float float_value;
+  double double_value;
+  bool bool_value;
+};
+
+static_assert(sizeof(NativeValue) == sizeof(uint64_t));
+
+/** @brief Converts an arithmetic value to its native storage. */
+template <typename T>
+NativeValue ToNative(T value) {
+  NativeValue native;
+  constexpr ValueKind kind = KindOf(TypeOf<T>());
+  if constexpr (kind == ValueKind::Signed) {
+    native.signed_value = static_cast<int64_t>(value);
+  } else if constexpr (kind == ValueKind::Unsigned) {
+    native.unsigned_value = static_cast<uint64_t>(value);
+  } else if constexpr (kind == ValueKind::Float) {
+    native.float_value = static_cast<float>(value);
+  } else if constexpr (kind == ValueKind::Double) {
+    native.double_value = static_cast<double>(value);
+  } else {
+    native.bool_value = static_cast<bool>(value);
+  }
+  return native;
+}
+
+/** @brief Converts a native value, stored as TypeOf<T>, back to T. */
+template <typename T>
+T FromNative(NativeValue native) {
+  constexpr ValueKind kind = KindOf(TypeOf<T>());
+  if constexpr (kind == ValueKind::Signed) {
+    return static_cast<T>(native.signed_value);
+  } else if constexpr (kind == ValueKind::Unsigned) {
+    return static_cast<T>(native.unsigned_value);
+  } else if constexpr (kind == ValueKind::Float) {
+    return static_cast<T>(native.float_value);
+  } else if constexpr (kind == ValueKind::Double) {
+    return static_cast<T>(native.double_value);
+  } else {
+    return static_cast<T>(native.bool_value);
+  }
+}
+
+/** @brief Seqlock protected storage of a typed native value.
+ *
+ * The slot holds a native value together with its type (the tag). Readers
+ * never take a lock and never block the writer. A reader retries if a write
+ * was in progress while reading, so it always gets a consistent pair of type
+ * and value.
+ *
+ * Only one writer is allowed at a time. Multiple writers must serialize
+ * themselves, typically by a mutex, before calling Store().
+ */
+class ValueSlot {
+ public:
+  ValueSlot() = default;
+  explicit ValueSlot(MetricType type) : type_(type) {}
+
+  void Store(MetricType type, NativeValue value) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    type_.store(type, std::memory_order_relaxed);
+    value_.store(std::bit_cast<uint64_t>(value), std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  void Load(MetricType& type, NativeValue& value) const {
+    uint32_t sequence1 = 0;
+    uint32_t sequence2 = 0;
+    uint64_t bits = 0;
+    do {
+      sequence1 = sequence_.load(std::memory_order_acquire);
+      type = type_.load(std::memory_order_relaxed);
+      bits = value_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      sequence2 = sequence_.load(std::memory_order_relaxed);
+    } while (sequence1 != sequence2 || (sequence1 & 1) != 0);
+    value = std::bit_cast<NativeValue>(bits);
+  }
+
+  [[nodiscard]] MetricType Type() const {
+    return type_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint32_t> sequence_ = 0; ///< Odd while a write is in progress.
+  std::atomic<MetricType> type_ = MetricType::String;
+  std::atomic<uint64_t> value_ = 0;
+};
+
+/** @brief Returns true if two native values of the same type are identical.
+ *
+ * The comparison is done bitwise, so a NaN value is equal to itself.
+ */
+[[nodiscard]] bool IsSameNative(MetricType type, NativeValue value1,
+                                NativeValue value2);
+
+/** @brief Converts a native value between two scalar types.
+ *
+ * The value is narrowed to the destination type, i.e. storing 300 into an
+ * Int8 type wraps as a static_cast<int8_t> does. A floating point value is
+ * instead truncated and clamped to the range of an integer type, and NaN
+ * becomes 0.
+ * @param from_type Type of the input value.
+ * @param to_type Requested type.
+ * @param value Input value.
+ * @return The value converted to the requested type.
+ */
+[[nodiscard]] NativeValue ConvertNative(MetricType from_type,
+                                        MetricType to_type, NativeValue value);
+
+/** @brief Converts a native value to text.
+ *
+ * Floating point values are formatted without loosing precision and always
+ * with a '.' as decimal point. Booleans are formatted as "1" or "0".
+ * @param type Type of the value.
+ * @param value Native value.
+ * @return The value as text.
+ */
+[[nodiscard]] std::string NativeToString(MetricType type, NativeValue value);
+
+/** @brief Parses a text into a native value.
+ *
+ * Leading white spaces are skipped and any trailing text, typical a unit,
+ * is ignored. Booleans are true if the text starts with 'Y', 'T' or '1'.
+ * @param type Requested type.
+ * @param text Text to parse.
+ * @param value Destination value. Unchanged if the parsing fails.
+ * @return True if the text was a valid value.
+ */
+[[nodiscard]] bool StringToNative(MetricType type, std::string_view text,
+                                  NativeValue& value);
+
+}  // namespace metric
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "metric/metricdatabase.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace metric {
+
+/** @brief Metric database that is persisted in an SQLite file.
+ *
+ * The groups, metrics, properties and the last values are stored in an
+ * SQLite file. Load() creates the groups and metrics with the bulk import
+ * and Save() writes the whole database in one transaction. The statements
+ * of a load or save are prepared once per call, and the flush statement
+ * once per connection. The journal is in WAL mode, so a save doesn't block
+ * readers of the file.
+ *
+ * The last values are written by a background thread. It takes a snapshot
+ * at each interval and writes the values that changed since the previous
+ * snapshot in one transaction, so the cost of a flush is proportional to
+ * the number of changes.
+ */
+class SqliteDatabase : public MetricDatabase {
+ public:
+  SqliteDatabase();
+  ~SqliteDatabase() override;
+
+  /** @brief Opens the file and loads the database, or closes the file.
+   *
+   * The background flush is only started if the database is concurrent,
+   * as it takes snapshots while other threads create and delete metrics.
+   * Otherwise call FlushValues(). Disabling flushes the last values and
+   * closes the file.
+   * @param enable True to open the file.
+   */
+  void Enable(bool enable) override;
+
+  /** @brief Opens or creates the file and its tables.
+   *
+   * @return True if the file is open.
+   */
+  bool Open();
+
+  /** @brief Stops the background flush and closes the file. */
+  void Close();
+  [[nodiscard]] bool IsOpen() const;
+
+  /** @brief Creates the groups and metrics that are stored in the file.
+   *
+   * Existing groups and metrics are kept. The stored last values are
+   * restored and count as flushed. The file is read before the groups and
+   * metrics are created, so the connection isn't locked meanwhile.
+   * @return True if the file was read without errors.
+   */
+  bool Load();
+
+  /** @brief Replaces the content of the file with the database.
+   *
+   * @return True if the transaction was committed.
+   */
+  bool Save();
+
+  /** @brief Writes the values that changed since the last flush.
+   *
+   * Metrics that aren't saved yet are added to the file.
+   * @return Number of written values.
+   */
+  size_t FlushValues();
+
+  /** @brief Sets the interval of the background flush.
+   *
+   * A running flush uses the new interval from its next wait.
+   */
+  void FlushInterval(std::chrono::milliseconds interval);
+  [[nodiscard]] std::chrono::milliseconds FlushInterval() const;
+
+  /** @brief Starts the background flush. Called by Enable(). */
+  void StartFlush();
+  /** @brief Stops the background flush and writes the last changes. */
+  void StopFlush();
+
+ private:
+  sqlite3* db_ = nullptr;
+  mutable std::mutex db_mutex_; ///< Serializes the use of the connection.
+  sqlite3_stmt* upsert_value_ = nullptr; ///< Flush statement.
+  std::shared_ptr<const MetricSnapshot> flushed_; ///< Last flushed values.
+
+  std::thread flush_thread_;
+  mutable std::mutex flush_mutex_; ///< Guards the interval and the stop.
+  std::chrono::milliseconds flush_interval_ = std::chrono::milliseconds(1000);
+  std::condition_variable flush_condition_;
+  bool stop_flush_ = false;
+
+  bool Execute(const char* sql);
+  void FlushTask();
+};
+
+}  // namespace metric
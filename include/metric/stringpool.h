@@ -0,0 +1,104 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "metric/metricindex.h"
+
+namespace metric {
+
+/** @brief Pool of interned (shared and immutable) strings.
+ *
+ * Each unique string is stored once and the pool returns a view of it, so
+ * the same name or key in thousands of metrics costs one allocation. Two
+ * views of the same pool are equal if they point to the same characters,
+ * which is an integer compare.
+ *
+ * Each Intern() and Retain() is a reference that is dropped with
+ * Release(). A string is freed when its last reference is released, so a
+ * pool only holds the strings in use, also when names are created and
+ * deleted dynamically. The view is valid until its reference is released.
+ * Interning is thread-safe and retaining or releasing a string that has
+ * other references is lock-free.
+ */
+class StringPool {
+ public:
+  StringPool() = default;
+  ~StringPool();
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  /** @brief Returns the pool used by objects without a database.
+   *
+   * The property keys and the names of standalone metrics are interned in
+   * this pool. It's never destroyed, so objects with static storage may
+   * release their strings at exit.
+   */
+  static StringPool& Global();
+
+  /** @brief Returns the interned copy of a text and adds a reference.
+   *
+   * @param text Text to intern.
+   * @return View of the pooled string.
+   */
+  [[nodiscard]] std::string_view Intern(std::string_view text);
+
+  /** @brief Adds a reference to an interned string.
+   *
+   * @param text View returned by Intern() of this pool, or an empty view.
+   */
+  static void Retain(std::string_view text);
+
+  /** @brief Drops a reference and frees the string if it was the last.
+   *
+   * @param text View returned by Intern() of this pool, or an empty view.
+   */
+  void Release(std::string_view text);
+
+  /** @brief Reserves room for more unique strings.
+   *
+   * Avoids that the pool grows step by step when many names are interned.
+   * @param count Number of strings to add.
+   */
+  void Reserve(size_t count);
+
+  /** @brief Returns number of unique strings in the pool. */
+  [[nodiscard]] size_t Size() const;
+
+  /** @brief Compares two interned strings by address.
+   *
+   * Both views must be interned in the same pool, as the characters are
+   * never compared. Compare the text when a view may come from another
+   * pool or isn't interned.
+   */
+  [[nodiscard]] static bool IsSame(std::string_view text1,
+                                   std::string_view text2) {
+    return text1.data() == text2.data() && text1.size() == text2.size();
+  }
+
+ private:
+  /** Reference count, stored in front of the characters. */
+  struct Header {
+    std::atomic<size_t> count = 0;
+  };
+
+  mutable std::mutex pool_mutex_;
+  /** Memory of the strings. Freed strings are reused by new strings. */
+  std::pmr::unsynchronized_pool_resource buffer_;
+  std::unordered_set<std::string_view, StringHash, std::equal_to<>>
+      string_list_;
+
+  [[nodiscard]] static Header& HeaderOf(std::string_view text);
+};
+
+}  // namespace metric
@@ -0,0 +1,16 @@
+# Copyright 2025 Ingemar Hedvall
+# SPDX-License-Identifier: MIT
+
+if (NOT SQLite3_FOUND)
+    find_package(SQLite3)
+    message(STATUS "SQLite3 Found (Try 1): " ${SQLite3_FOUND})
+    if (NOT SQLite3_FOUND AND COMP_DIR)
+        set(SQLite3_ROOT ${COMP_DIR}/sqlite3/master)
+        find_package(SQLite3)
+        message(STATUS "SQLite3 Found (Try 2): " ${SQLite3_FOUND})
+    endif()
+endif()
+
+message(STATUS "SQLite3 Version: " ${SQLite3_VERSION})
+message(STATUS "SQLite3 Include Dirs: " ${SQLite3_INCLUDE_DIRS})
+message(STATUS "SQLite3 Libraries: " ${SQLite3_LIBRARIES})
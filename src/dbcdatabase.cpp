@@ -0,0 +1,163 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/dbcdatabase.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dbcparser.h"
+#include "mappedfile.h"
+
+namespace {
+
+constexpr size_t kNofProperties = 9;
+using PropertyTemplate = std::array<metric::MetricProperty, kNofProperties>;
+
+template <typename T>
+metric::MetricProperty MakeProperty(std::string_view key) {
+  metric::MetricProperty property;
+  property.Key(key);
+  property.DataType(metric::TypeOf<T>());
+  return property;
+}
+
+/** Appends a copy of the template property with a value. The copy only
+ * retains the interned key. */
+template <typename T>
+void AppendProperty(metric::MetricPropertyList& property_list,
+                    const metric::MetricProperty& key, T value) {
+  metric::MetricProperty& property = property_list.Insert(key);
+  property.Value(std::move(value));
+}
+
+/** Returns true if a metric in the list has the name. */
+bool IsDuplicate(const std::vector<metric::Metric*>& metric_list,
+                 std::string_view name) {
+  return std::ranges::any_of(metric_list, [&](const metric::Metric* metric) {
+    return metric->Name() == name;
+  });
+}
+
+/** Returns the properties of a signal. The list is allocated once and
+ * empty texts aren't stored. */
+metric::MetricPropertyList MakeProperties(
+    const metric::DbcSignal& signal,
+    const PropertyTemplate& property_template) {
+  metric::MetricPropertyList property_list;
+  property_list.Reserve(kNofProperties);
+  AppendProperty(property_list, property_template[0],
+                 signal.little_endian ? "little_endian" : "big_endian");
+  if (!signal.comment.empty()) {
+    AppendProperty(property_list, property_template[1],
+                   metric::DbcParser::Unescape(signal.comment));
+  }
+  AppendProperty(property_list, property_template[2], signal.factor);
+  AppendProperty(property_list, property_template[3], signal.length);
+  AppendProperty(property_list, property_template[4], signal.max);
+  AppendProperty(property_list, property_template[5], signal.min);
+  AppendProperty(property_list, property_template[6], signal.offset);
+  AppendProperty(property_list, property_template[7], signal.start_bit);
+  if (!signal.unit.empty()) {
+    AppendProperty(property_list, property_template[8], signal.unit);
+  }
+  return property_list;
+}
+
+}  // namespace
+
+namespace metric {
+
+DbcDatabase::DbcDatabase() {
+  type_ = TypeOfDatabase::DbcFile;
+}
+
+void DbcDatabase::Enable(bool enable) {
+  if (enable == IsEnabled()) {
+    return;
+  }
+  enabled_ = enable;
+  operable_ = enable && Load();
+}
+
+bool DbcDatabase::Load() {
+  error_line_ = 0;
+  const MappedFile file(Filename());
+  if (!file.IsOpen()) {
+    return false;
+  }
+  DbcParser parser(file.Text());
+  if (!parser.Parse()) {
+    error_line_ = parser.ErrorLine();
+    return false;
+  }
+
+  size_t nof_signals = 0;
+  for (const DbcMessage& message : parser.Messages()) {
+    nof_signals += message.signal_list.size();
+  }
+
+  // The keys are interned once instead of once per signal. The template is
+  // sorted by key, so a signal's list is filled by appending in order.
+  const PropertyTemplate property_template = {
+      MetricProperty("byte_order", {}),
+      MetricProperty("description", {}),
+      MakeProperty<double>("factor"),
+      MakeProperty<uint32_t>("length"),
+      MakeProperty<double>("max"),
+      MakeProperty<double>("min"),
+      MakeProperty<double>("offset"),
+      MakeProperty<uint32_t>("start_bit"),
+      MetricProperty("unit", {}),
+  };
+
+  // The metrics are created directly, as a list of definitions would copy
+  // every name, unit and property once more
+  std::scoped_lock lock(list_mutex_);
+  ReserveMetrics(nof_signals);
+  std::vector<Metric*> group_metrics;
+  for (const DbcMessage& message : parser.Messages()) {
+    if (message.name == "VECTOR__INDEPENDENT_SIG_MSG") {
+      continue; // Pseudo message of unused signals
+    }
+    const auto identity = static_cast<int32_t>(message.CanId());
+    MetricGroup* group = AddGroup(std::string(message.name), identity);
+    if (group == nullptr) {
+      continue;
+    }
+    group->Type(TypeOfGroup::CanMessage);
+    if (!message.comment.empty()) {
+      group->Description(DbcParser::Unescape(message.comment));
+    }
+    ReserveGroup(*group, message.signal_list.size());
+
+    // All metrics of the group key are in the group, so a new group can
+    // only get a duplicate from its own message. The few metrics of the
+    // message are then compared instead of looked up in the index.
+    const bool is_new = group->Metrics().empty();
+    group_metrics.clear();
+    for (const DbcSignal& signal : message.signal_list) {
+      if (is_new ? IsDuplicate(group_metrics, signal.name)
+                 : metric_index_.Find(group->Name(), identity, signal.name) !=
+                       nullptr) {
+        continue;
+      }
+      Metric* metric = AddUnorderedMetric(*group, signal.name);
+      if (metric == nullptr) {
+        continue;
+      }
+      metric->DataType(signal.DataType());
+      metric->Properties(MakeProperties(signal, property_template));
+      group_metrics.push_back(metric);
+    }
+    metric_order_.Add(group_metrics);
+  }
+  return true;
+}
+
+}  // namespace metric
@@ -0,0 +1,324 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "dbcparser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <system_error>
+
+namespace {
+
+bool IsWordChar(char character) {
+  return (character >= 'A' && character <= 'Z') ||
+         (character >= 'a' && character <= 'z') ||
+         (character >= '0' && character <= '9') || character == '_';
+}
+
+bool IsIntegral(double value) {
+  return std::trunc(value) == value;
+}
+
+/** Powers of two are exact in a double, so the limits are compared
+ * without rounding. */
+constexpr double kInt64Limit = 9223372036854775808.0;   // 2^63
+constexpr double kUInt64Limit = 18446744073709551616.0; // 2^64
+
+}  // namespace
+
+namespace metric {
+
+MetricType DbcSignal::DataType() const {
+  if (is_float || !IsIntegral(factor) || !IsIntegral(offset)) {
+    return MetricType::Double;
+  }
+  if (factor != 1.0 || offset != 0.0) {
+    // The scaled value may be larger than the raw value, so the type is
+    // selected by the scaled range of the raw value
+    const int bits = static_cast<int>(std::min(length, 64U));
+    double raw_min = 0.0;
+    double raw_max = std::ldexp(1.0, bits) - 1.0;
+    if (is_signed && bits > 0) {
+      raw_min = -std::ldexp(1.0, bits - 1);
+      raw_max = std::ldexp(1.0, bits - 1) - 1.0;
+    }
+    const double scaled_min =
+        std::min(raw_min * factor, raw_max * factor) + offset;
+    const double scaled_max =
+        std::max(raw_min * factor, raw_max * factor) + offset;
+    if (scaled_min >= -kInt64Limit && scaled_max < kInt64Limit) {
+      return MetricType::Int64;
+    }
+    if (scaled_min >= 0.0 && scaled_max < kUInt64Limit) {
+      return MetricType::UInt64;
+    }
+    return MetricType::Double;
+  }
+  if (length == 1 && !is_signed) {
+    return MetricType::Boolean;
+  }
+  if (length <= 8) {
+    return is_signed ? MetricType::Int8 : MetricType::UInt8;
+  }
+  if (length <= 16) {
+    return is_signed ? MetricType::Int16 : MetricType::UInt16;
+  }
+  if (length <= 32) {
+    return is_signed ? MetricType::Int32 : MetricType::UInt32;
+  }
+  return is_signed ? MetricType::Int64 : MetricType::UInt64;
+}
+
+bool DbcParser::Parse() {
+  pos_ = 0;
+  error_line_ = 0;
+  message_list_.clear();
+  message_index_.clear();
+  while (!IsEnd()) {
+    // Each statement starts with a keyword
+    const char character = text_[pos_];
+    if (character == ' ' || character == '\t' || character == '\r' ||
+        character == '\n') {
+      ++pos_;
+      continue;
+    }
+    bool valid = true;
+    if (const std::string_view keyword = Word(); keyword == "SG_") {
+      valid = ParseSignal();
+    } else if (keyword == "BO_") {
+      valid = ParseMessage();
+    } else if (keyword == "CM_") {
+      ParseComment();
+    } else if (keyword == "SIG_VALTYPE_") {
+      ParseValueType();
+    } else if (keyword == "NS_") {
+      SkipNewSymbols();
+    } else {
+      SkipStatement();
+    }
+    if (!valid) {
+      error_line_ = 1 + static_cast<size_t>(
+          std::count(text_.begin(), text_.begin() + static_cast<ptrdiff_t>(
+                                                        std::min(pos_, text_.size())),
+                     '\n'));
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string DbcParser::Unescape(std::string_view text) {
+  std::string dest;
+  dest.reserve(text.size());
+  for (size_t index = 0; index < text.size(); ++index) {
+    if (text[index] == '\\' && index + 1 < text.size()) {
+      ++index;
+    }
+    dest.push_back(text[index]);
+  }
+  return dest;
+}
+
+void DbcParser::SkipSpace() {
+  while (!IsEnd() && (text_[pos_] == ' ' || text_[pos_] == '\t')) {
+    ++pos_;
+  }
+}
+
+void DbcParser::SkipLine() {
+  const size_t next = text_.find('\n', pos_);
+  pos_ = next == std::string_view::npos ? text_.size() : next + 1;
+}
+
+void DbcParser::SkipStatement() {
+  bool in_quote = false;
+  for (; !IsEnd(); ++pos_) {
+    const char character = text_[pos_];
+    if (in_quote && character == '\\') {
+      ++pos_;
+    } else if (character == '"') {
+      in_quote = !in_quote;
+    } else if (character == '\n' && !in_quote) {
+      ++pos_;
+      return;
+    }
+  }
+}
+
+void DbcParser::SkipNewSymbols() {
+  // The symbol list is indented lines after the NS_ line
+  SkipLine();
+  while (!IsEnd()) {
+    const char character = text_[pos_];
+    if (character != ' ' && character != '\t' && character != '\r' &&
+        character != '\n') {
+      break;
+    }
+    SkipLine();
+  }
+}
+
+bool DbcParser::Expect(char character) {
+  SkipSpace();
+  if (IsEnd() || text_[pos_] != character) {
+    return false;
+  }
+  ++pos_;
+  return true;
+}
+
+std::string_view DbcParser::Word() {
+  SkipSpace();
+  const size_t first = pos_;
+  while (!IsEnd() && IsWordChar(text_[pos_])) {
+    ++pos_;
+  }
+  return text_.substr(first, pos_ - first);
+}
+
+bool DbcParser::String(std::string_view& text) {
+  while (!IsEnd() && text_[pos_] != '"') {
+    const char character = text_[pos_];
+    if (character != ' ' && character != '\t' && character != '\r' &&
+        character != '\n') {
+      return false;
+    }
+    ++pos_;
+  }
+  if (IsEnd()) {
+    return false;
+  }
+  const size_t first = ++pos_;
+  for (; !IsEnd(); ++pos_) {
+    if (text_[pos_] == '\\') {
+      ++pos_;
+    } else if (text_[pos_] == '"') {
+      text = text_.substr(first, pos_ - first);
+      ++pos_;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+bool DbcParser::Number(T& value) {
+  SkipSpace();
+  if (!IsEnd() && text_[pos_] == '+') {
+    ++pos_;
+  }
+  const char* first = text_.data() + pos_;
+  const auto [end, error] =
+      std::from_chars(first, text_.data() + text_.size(), value);
+  if (error != std::errc()) {
+    return false;
+  }
+  pos_ += static_cast<size_t>(end - first);
+  return true;
+}
+
+bool DbcParser::ParseMessage() {
+  DbcMessage message;
+  if (!Number(message.id)) {
+    return false;
+  }
+  message.name = Word();
+  if (message.name.empty() || !Expect(':') || !Number(message.dlc)) {
+    return false;
+  }
+  SkipLine(); // Transmitter
+  message_index_.emplace(message.id, message_list_.size());
+  message_list_.push_back(std::move(message));
+  return true;
+}
+
+bool DbcParser::ParseSignal() {
+  if (message_list_.empty()) {
+    return false;
+  }
+  DbcSignal signal;
+  signal.name = Word();
+  if (signal.name.empty()) {
+    return false;
+  }
+  SkipSpace();
+  if (!IsEnd() && text_[pos_] != ':') {
+    Word(); // Multiplexer indicator
+  }
+  if (!Expect(':') || !Number(signal.start_bit) || !Expect('|') ||
+      !Number(signal.length) || !Expect('@')) {
+    return false;
+  }
+  if (pos_ + 2 > text_.size()) {
+    return false;
+  }
+  signal.little_endian = text_[pos_++] == '1';
+  signal.is_signed = text_[pos_++] == '-';
+  if (!Expect('(') || !Number(signal.factor) || !Expect(',') ||
+      !Number(signal.offset) || !Expect(')') || !Expect('[') ||
+      !Number(signal.min) || !Expect('|') || !Number(signal.max) ||
+      !Expect(']') || !String(signal.unit)) {
+    return false;
+  }
+  SkipLine(); // Receivers
+  message_list_.back().signal_list.push_back(signal);
+  return true;
+}
+
+void DbcParser::ParseComment() {
+  SkipSpace();
+  std::string_view comment;
+  if (const std::string_view kind = Word(); kind == "BO_") {
+    uint32_t id = 0;
+    if (Number(id) && String(comment)) {
+      if (DbcMessage* message = FindMessage(id); message != nullptr) {
+        message->comment = comment;
+      }
+    }
+  } else if (kind == "SG_") {
+    uint32_t id = 0;
+    if (Number(id)) {
+      const std::string_view name = Word();
+      if (String(comment)) {
+        if (DbcSignal* signal = FindSignal(id, name); signal != nullptr) {
+          signal->comment = comment;
+        }
+      }
+    }
+  }
+  // The rest of the statement, or a comment of another kind
+  SkipStatement();
+}
+
+void DbcParser::ParseValueType() {
+  uint32_t id = 0;
+  uint32_t type = 0;
+  if (Number(id)) {
+    const std::string_view name = Word();
+    if (Expect(':') && Number(type) && type != 0) {
+      if (DbcSignal* signal = FindSignal(id, name); signal != nullptr) {
+        signal->is_float = true;
+      }
+    }
+  }
+  SkipStatement();
+}
+
+DbcMessage* DbcParser::FindMessage(uint32_t id) {
+  auto itr = message_index_.find(id);
+  return itr != message_index_.end() ? &message_list_[itr->second] : nullptr;
+}
+
+DbcSignal* DbcParser::FindSignal(uint32_t id, std::string_view name) {
+  DbcMessage* message = FindMessage(id);
+  if (message == nullptr) {
+    return nullptr;
+  }
+  auto itr = std::ranges::find(message->signal_list, name, &DbcSignal::name);
+  return itr != message->signal_list.end() ? &*itr : nullptr;
+}
+
+}  // namespace metric
@@ -0,0 +1,107 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "metric/metrictype.h"
+
+namespace metric {
+
+/** @brief Signal of a CAN message in a DBC file.
+ *
+ * The texts are views of the parsed text. A comment may contain escaped
+ * quotes, so use DbcParser::Unescape() before it is shown.
+ */
+struct DbcSignal {
+  std::string_view name;
+  uint32_t start_bit = 0;
+  uint32_t length = 0;
+  bool little_endian = true;
+  bool is_signed = false;
+  bool is_float = false; ///< Set by SIG_VALTYPE_.
+  double factor = 1.0;
+  double offset = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  std::string_view unit;
+  std::string_view comment;
+
+  /** @brief Returns the metric type of the scaled value. */
+  [[nodiscard]] MetricType DataType() const;
+};
+
+/** @brief CAN message in a DBC file. */
+struct DbcMessage {
+  uint32_t id = 0; ///< Bit 31 is set for extended identifiers.
+  std::string_view name;
+  uint32_t dlc = 0;
+  std::string_view comment;
+  std::vector<DbcSignal> signal_list;
+
+  /** @brief Returns the CAN identifier without the extended flag. */
+  [[nodiscard]] uint32_t CanId() const { return id & 0x1FFFFFFF; }
+};
+
+/** @brief Parser of the messages, signals and comments in a DBC file.
+ *
+ * The text is scanned once and the parser never copies it, so the text,
+ * typical a memory mapped file, must outlive the parser result. Statements
+ * that don't define messages, signals, comments or float signals are
+ * skipped.
+ */
+class DbcParser {
+ public:
+  explicit DbcParser(std::string_view text) : text_(text) {}
+
+  /** @brief Parses the text.
+   *
+   * @return False if a message or signal statement is invalid.
+   */
+  bool Parse();
+
+  [[nodiscard]] const std::vector<DbcMessage>& Messages() const {
+    return message_list_;
+  }
+
+  /** @brief Returns the line of the first error or 0. */
+  [[nodiscard]] size_t ErrorLine() const { return error_line_; }
+
+  /** @brief Returns a comment without the escape characters. */
+  [[nodiscard]] static std::string Unescape(std::string_view text);
+
+ private:
+  std::string_view text_;
+  size_t pos_ = 0;
+  size_t error_line_ = 0;
+  std::vector<DbcMessage> message_list_;
+  std::unordered_map<uint32_t, size_t> message_index_; ///< Id to index.
+
+  [[nodiscard]] bool IsEnd() const { return pos_ >= text_.size(); }
+  void SkipSpace();           ///< Skips spaces and tabs but not new lines.
+  void SkipLine();            ///< Skips past the next new line.
+  void SkipStatement();       ///< Skips a statement that may span lines.
+  bool Expect(char character);
+  std::string_view Word();    ///< Reads an identifier.
+  bool String(std::string_view& text); ///< Reads a quoted string.
+  template <typename T>
+  bool Number(T& value);
+
+  bool ParseMessage();
+  bool ParseSignal();
+  void ParseComment();
+  void ParseValueType();
+  void SkipNewSymbols();
+
+  DbcMessage* FindMessage(uint32_t id);
+  DbcSignal* FindSignal(uint32_t id, std::string_view name);
+};
+
+}  // namespace metric
@@ -0,0 +1,101 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace metric {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  file_ = file;
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(file, &size)) {
+    return;
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  if (size_ == 0) {
+    is_open_ = true;
+    return;
+  }
+  mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_ == nullptr) {
+    size_ = 0;
+    return;
+  }
+  data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+  if (data_ == nullptr) {
+    size_ = 0;
+    return;
+  }
+  is_open_ = true;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != nullptr) {
+    CloseHandle(file_);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) {
+  const int file = open(filename.c_str(), O_RDONLY);
+  if (file < 0) {
+    return;
+  }
+  struct stat info = {};
+  if (fstat(file, &info) != 0) {
+    close(file);
+    return;
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ == 0) {
+    close(file);
+    is_open_ = true;
+    return;
+  }
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping keeps the file open
+  close(file);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    return;
+  }
+  madvise(data, size_, MADV_SEQUENTIAL);
+  data_ = data;
+  is_open_ = true;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<void*>(data_), size_);
+  }
+}
+
+#endif
+
+}  // namespace metric
@@ -0,0 +1,44 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace metric {
+
+/** @brief Read-only memory mapping of a file.
+ *
+ * The file is mapped instead of read, so a large file is never copied
+ * into the heap and the pages are loaded by the OS when they are used.
+ * The text is valid as long as the object exists.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  [[nodiscard]] bool IsOpen() const { return is_open_; }
+
+  /** @brief Returns the content of the file. */
+  [[nodiscard]] std::string_view Text() const {
+    return {static_cast<const char*>(data_), size_};
+  }
+
+ private:
+  bool is_open_ = false;
+  const void* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace metric
@@ -5,49 +5,189 @@
 
 #include "metric/metric.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <utility>
+
+#include "metric/metricgroup.h"
 #include "metrichelper.h"
 
+namespace {
+
+bool IsSameLayout(metric::MetricType type1, metric::MetricType type2) {
+  using metric::MetricType;
+  if (type1 == type2) {
+    return true;
+  }
+  // Date and time values are stored as 64-bit unsigned integers
+  const auto is_uint64 = [](MetricType type) -> bool {
+    return type == MetricType::UInt64 || type == MetricType::DateTime;
+  };
+  return is_uint64(type1) && is_uint64(type2);
+}
+
+}  // namespace
+
 namespace metric {
 
+namespace {
 
-Metric::Metric(std::string  name)
-  : name_(std::move(name)) {
+/** Shared by all metrics without properties. It's never modified. */
+const MetricPropertyList kEmptyPropertyList;
 
+/** Returns the empty list without ownership, so a copy doesn't touch any
+ * reference count. */
+std::shared_ptr<const MetricPropertyList> EmptyPropertyList() {
+  return {std::shared_ptr<void>(), &kEmptyPropertyList};
 }
 
-Metric::Metric(const std::string_view& name)
-    : name_(name.data()) {
-}
+}  // namespace
 
-void Metric::Name(std::string name) {
-  std::scoped_lock lock(metric_mutex_);
-  name_ = std::move(name);
+/** All writers of a metric in a group take the frame lock of the group, so
+ * the frame lock serializes them and scalar values need no other lock.
+ * Text and array values also take the metric lock, as their readers do.
+ * The lock is retried if the group changes meanwhile, so two writers never
+ * use different locks.
+ */
+class Metric::WriteLock {
+ public:
+  WriteLock(Metric& metric, bool lock_metric) : metric_(metric) {
+    while (true) {
+      group_ = metric.group_.load(std::memory_order_acquire);
+      if (group_ == nullptr) {
+        metric_lock_ = std::unique_lock(metric.metric_mutex_);
+        if (metric.group_.load(std::memory_order_acquire) == nullptr) {
+          metric_.BeginWrite();
+          return;
+        }
+        metric_lock_.unlock();
+        continue;
+      }
+      group_->BeginUpdate();
+      if (metric.group_.load(std::memory_order_acquire) == group_) {
+        break;
+      }
+      group_->EndUpdate();
+    }
+    if (lock_metric || !IsScalar(metric.DataType())) {
+      metric_lock_ = std::unique_lock(metric.metric_mutex_);
+    }
+    metric_.BeginWrite();
+  }
+
+  ~WriteLock() {
+    metric_.EndWrite();
+    if (metric_lock_.owns_lock()) {
+      metric_lock_.unlock();
+    }
+    if (group_ != nullptr) {
+      group_->EndUpdate();
+    }
+  }
+
+  WriteLock(const WriteLock&) = delete;
+  WriteLock& operator=(const WriteLock&) = delete;
+
+ private:
+  const Metric& metric_;
+  MetricGroup* group_ = nullptr;
+  std::unique_lock<std::recursive_mutex> metric_lock_;
+};
+
+Metric::Metric()
+    : property_list_(EmptyPropertyList()) {
 }
 
-std::string Metric::Name() const {
-  std::scoped_lock lock(metric_mutex_);
-  return name_;
+Metric::Metric(std::string_view name)
+    : name_(StringPool::Global().Intern(name)),
+      string_pool_(&StringPool::Global()),
+      property_list_(EmptyPropertyList()) {
 }
 
-void Metric::GroupName(std::string name) {
-  std::scoped_lock lock(metric_mutex_);
-  group_name_ = std::move(name);
+Metric::Metric(std::string_view group_name, int64_t group_identity,
+               std::string_view name, StringPool& pool)
+    : name_(pool.Intern(name)),
+      group_name_(pool.Intern(group_name)),
+      string_pool_(&pool),
+      group_identity_(group_identity),
+      property_list_(EmptyPropertyList()) {
 }
 
-std::string Metric::GroupName() const {
-  std::scoped_lock lock(metric_mutex_);
-  return group_name_;
+Metric::Metric(Metric&& metric) noexcept
+    : property_list_(EmptyPropertyList()) {
+  *this = std::move(metric);
 }
 
-void Metric::GroupIdentity(int64_t identity) {
-  std::scoped_lock lock(metric_mutex_);
-  group_identity_ = identity;
+Metric::~Metric() {
+  if (string_pool_ != nullptr) {
+    string_pool_->Release(name_);
+    string_pool_->Release(group_name_);
+  }
 }
 
-int64_t Metric::GroupIdentity() const {
-  std::scoped_lock lock(metric_mutex_);
-  return group_identity_;
+Metric& Metric::operator=(Metric&& metric) noexcept {
+  if (this == &metric) {
+    return *this;
+  }
+  std::scoped_lock lock(metric_mutex_, metric.metric_mutex_);
+  if (string_pool_ != nullptr) {
+    string_pool_->Release(name_);
+    string_pool_->Release(group_name_);
+  }
+  name_ = std::exchange(metric.name_, {});
+  group_name_ = std::exchange(metric.group_name_, {});
+  string_pool_ = std::exchange(metric.string_pool_, nullptr);
+  group_identity_ = std::exchange(metric.group_identity_, 0);
+  identity_ = metric.identity_.exchange(0);
+  handle_ = std::exchange(metric.handle_, {});
+  group_ = metric.group_.exchange(nullptr);
+  is_historical_ = metric.is_historical_.exchange(false);
+  is_transient_ = metric.is_transient_.exchange(false);
+  is_null_ = metric.is_null_.exchange(false);
+  read_only_ = metric.read_only_.exchange(false);
+
+  // The readers share the list, so the move doesn't invalidate any property
+  property_list_.store(metric.property_list_.exchange(EmptyPropertyList()),
+                       std::memory_order_release);
+
+  deadband_ = metric.deadband_.exchange(0.0);
+  percent_deadband_ = metric.percent_deadband_.exchange(0.0);
+  min_interval_ = metric.min_interval_.exchange(0);
+  history_capacity_ = metric.history_capacity_.exchange(
+      MetricHistory::kDefaultCapacity);
+  history_ = metric.history_.exchange(nullptr);
+
+  queue_ = metric.queue_.exchange(nullptr);
+  change_set_ = metric.change_set_.exchange(nullptr);
+  // The row in the column store moves with the metric
+  column_ = std::exchange(metric.column_, nullptr);
+  column_offset_ = std::exchange(metric.column_offset_, 0);
+
+  MetricType type = MetricType::String;
+  NativeValue value;
+  metric.value_slot_.Load(type, value);
+  value_slot_.Store(type, value);
+  metric.value_slot_.Store(MetricType::String, NativeValue());
+  timestamp_ = metric.timestamp_.exchange(0);
+  valid_ = metric.valid_.exchange(false);
+  updated_ = metric.updated_.exchange(false);
+  queued_ = false;
+  next_queued_ = nullptr;
+  accepted_updates_ = metric.accepted_updates_.exchange(0);
+  suppressed_updates_ = metric.suppressed_updates_.exchange(0);
+  has_value_ = std::exchange(metric.has_value_, false);
+  last_accepted_time_ = std::exchange(metric.last_accepted_time_, 0);
+
+  text_ = std::move(metric.text_);
+  array_ = std::move(metric.array_);
+  string_array_ = std::move(metric.string_array_);
+  metric.text_.clear();
+  metric.array_.clear();
+  metric.string_array_.clear();
+  return *this;
 }
 
 void Metric::Description(std::string desc) {
@@ -58,8 +198,8 @@ std::string Metric::Description() const {
   return GetStringProperty("description");
 }
 
-void Metric::Unit(const std::string &name) {
-  SetStringProperty("unit", name);
+void Metric::Unit(std::string unit) {
+  SetStringProperty("unit", std::move(unit));
 }
 
 std::string Metric::Unit() const {
@@ -67,233 +207,676 @@ std::string Metric::Unit() const {
 }
 
 
-/** @brief In MQTT the value are sent as string value. Sometimes the value is appended with
- * a unit string.
- *
- * The MQTT payload normally uses string values to send values. Sometimes a unit string is appended
- * to the string. So if the value is a decimal value, search for an optional unit string.
- * @param value String value with optional unit
- */
-template<>
-void Metric::Value(std::string value) {
-  bool updated = false;
-  {
+void Metric::Group(MetricGroup* group) {
+  MetricGroup* old_group = group_.exchange(group, std::memory_order_acq_rel);
+  if (old_group == group) {
+    return;
+  }
+  // A writer that took the old lock has finished when the lock is free
+  if (old_group != nullptr) {
+    old_group->BeginUpdate();
+    old_group->EndUpdate();
+  } else {
     std::scoped_lock lock(metric_mutex_);
-    if (updated = value != value_; updated ) {
-      value_ = std::move(value);
+  }
+}
+
+void Metric::Timestamp(uint64_t ms_since_1970) {
+  {
+    WriteLock lock(*this, false);
+    TimestampCell() = ms_since_1970;
+  }
+  MarkChanged();
+}
+
+void Metric::DataType(MetricType type) {
+  WriteLock lock(*this, true);
+  MetricType old_type = MetricType::String;
+  NativeValue value;
+  Slot().Load(old_type, value);
+  if (old_type == type) {
+    return;
+  }
+  if (history_.load(std::memory_order_relaxed)) {
+    // The history is stored as the data type, so it starts over
+    history_ = std::make_shared<MetricHistory>(history_capacity_);
+  }
+  if (IsScalar(old_type) && IsScalar(type)) {
+    Slot().Store(type, ConvertNative(old_type, type, value));
+    MarkChanged();
+    return;
+  }
+
+  // Convert the value through its text representation. A conversion isn't
+  // a new sample, so it bypasses the filters, counters and history.
+  const std::string text = TextLocked(old_type, value);
+  text_.clear();
+  array_.clear();
+  string_array_.clear();
+  Slot().Store(type, NativeValue());
+  if (IsScalar(type)) {
+    if (NativeValue new_value; StringToNative(type, text, new_value)) {
+      Slot().Store(type, new_value);
     }
+  } else {
+    bool updated = false;
+    ParseLocked(type, text, updated);
   }
-  Valid(true);
-  if (updated) {
-    SetUpdated();
+  MarkChanged();
+}
+
+void Metric::Historical(bool historical_value) {
+  std::scoped_lock lock(metric_mutex_);
+  is_historical_ = historical_value;
+  if (historical_value && !history_.load(std::memory_order_relaxed)) {
+    history_ = std::make_shared<MetricHistory>(history_capacity_);
+  } else if (!historical_value) {
+    // Readers that hold the buffer keep it alive
+    history_.store(nullptr, std::memory_order_release);
   }
 }
 
-template<>
-void Metric::Value(std::string_view value) {
-  bool updated = false;
-  {
-    std::scoped_lock lock(metric_mutex_);
-    if (updated = value_ != value; updated ) {
-      value_ = value;
+void Metric::HistoryCapacity(size_t capacity) {
+  std::scoped_lock lock(metric_mutex_);
+  history_capacity_ = capacity;
+  if (const auto history = history_.load(std::memory_order_relaxed);
+      history && history->Capacity() != capacity) {
+    history_ = std::make_shared<MetricHistory>(capacity);
+  }
+}
+
+void Metric::Deadband(double deadband) {
+  deadband_ = std::abs(deadband);
+}
+
+void Metric::PercentDeadband(double percent) {
+  percent_deadband_ = std::abs(percent);
+}
+
+void Metric::ResetUpdateCounters() {
+  accepted_updates_ = 0;
+  suppressed_updates_ = 0;
+}
+
+uint64_t Metric::SampleTime() const {
+  if (const uint64_t timestamp = Timestamp(); timestamp > 0) {
+    return timestamp;
+  }
+  const auto now = std::chrono::system_clock::now();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          now.time_since_epoch()).count());
+}
+
+bool Metric::IsFilteredLocked(MetricType data_type, NativeValue old_value,
+                              NativeValue new_value, uint64_t sample_time) {
+  if (!has_value_) {
+    return false; // Always accept the first value
+  }
+  if (const uint64_t min_interval = min_interval_;
+      min_interval > 0 && sample_time >= last_accepted_time_ &&
+      sample_time - last_accepted_time_ < min_interval) {
+    return true;
+  }
+
+  const double deadband = deadband_;
+  const double percent_deadband = percent_deadband_;
+  if (data_type == MetricType::Boolean ||
+      (deadband <= 0.0 && percent_deadband <= 0.0)) {
+    return false;
+  }
+  const double old_number =
+      ConvertNative(data_type, MetricType::Double, old_value).double_value;
+  const double new_number =
+      ConvertNative(data_type, MetricType::Double, new_value).double_value;
+  const double change = std::abs(new_number - old_number);
+  if (deadband > 0.0 && change <= deadband) {
+    return true;
+  }
+  return percent_deadband > 0.0 &&
+         change <= std::abs(old_number) * percent_deadband / 100.0;
+}
+
+bool Metric::UpdateLocked(MetricType data_type, NativeValue old_value,
+                          NativeValue new_value) {
+  if (is_historical_) {
+    // The history stores every sample, not only the accepted changes
+    if (const auto history = history_.load(std::memory_order_acquire)) {
+      history->Append(Timestamp(), new_value);
     }
   }
-  Valid(true);
-  if (updated) {
-    SetUpdated();
+  if (IsSameNative(data_type, new_value, old_value)) {
+    return false;
   }
+  const uint64_t sample_time = min_interval_ > 0 ? SampleTime() : 0;
+  if (IsFilteredLocked(data_type, old_value, new_value, sample_time)) {
+    ++suppressed_updates_;
+    return false;
+  }
+  ++accepted_updates_;
+  has_value_ = true;
+  last_accepted_time_ = sample_time;
+  Slot().Store(data_type, new_value);
+  return true;
 }
 
-template<>
-void Metric::Value(const char* value) {
+bool Metric::StoreValueLocked(MetricType type, NativeValue value,
+                              bool& changed) {
   bool updated = false;
-  {
-    std::scoped_lock lock(metric_mutex_);
-    if (value == nullptr && !value_.empty()) {
-      updated = true;
-      value_.clear();
-    } else if (value != nullptr && value_ != value) {
-      updated = true;
-      value_ = value;
+  MetricType data_type = MetricType::String;
+  NativeValue old_value;
+  Slot().Load(data_type, old_value);
+  switch (KindOf(data_type)) {
+    case ValueKind::Text: {
+      NumberBuffer buffer;
+      if (const std::string_view new_value =
+              NativeToChars(type, value, buffer);
+          new_value != text_) {
+        updated = true;
+        text_ = new_value;
+      }
+      break;
+    }
+
+    case ValueKind::Array: {
+      // A single value into an array metric is an array with one element
+      std::array<uint8_t, sizeof(NativeValue)> element = {};
+      StoreElement(type, value, element.data());
+      updated = StoreArrayLocked(data_type, type, element.data(), 1);
+      break;
+    }
+
+    default: {
+      updated = UpdateLocked(data_type, old_value,
+                             ConvertNative(type, data_type, value));
+      break;
     }
   }
-  Valid(true);
-  if (updated) {
-    SetUpdated();
+  if (!ValidCell().exchange(true)) {
+    changed = true;
   }
+  return updated;
 }
 
-template<>
-void Metric::Value(bool value) {
+bool Metric::StoreValue(MetricType type, NativeValue value) {
   bool updated = false;
+  bool changed = false;
   {
-    std::scoped_lock lock(metric_mutex_);
-    const std::string old_value = value_;
-    value_ = value ? "1" : "0";
-    updated = old_value != value_;
+    WriteLock lock(*this, false);
+    updated = StoreValueLocked(type, value, changed);
+  }
+  Notify(updated, changed);
+  return updated;
+}
+
+bool Metric::Update(uint64_t timestamp, MetricType type, NativeValue value) {
+  bool updated = false;
+  bool changed = true; // The timestamp is set
+  {
+    WriteLock lock(*this, false);
+    TimestampCell() = timestamp;
+    updated = StoreValueLocked(type, value, changed);
+  }
+  Notify(updated, changed);
+  return updated;
+}
+
+bool Metric::WriteFrame(uint64_t timestamp, MetricType type,
+                        NativeValue value) {
+  std::unique_lock lock(metric_mutex_, std::defer_lock);
+  if (!IsScalar(DataType())) {
+    lock.lock();
+  }
+  BeginWrite();
+  TimestampCell() = timestamp;
+  bool changed = false;
+  const bool updated = StoreValueLocked(type, value, changed);
+  EndWrite();
+  if (updated) {
+    updated_ = true;
+  }
+  return updated;
+}
+
+void Metric::PublishFrame() {
+  MarkChanged();
+  if (MetricQueue* queue = queue_; queue != nullptr && updated_) {
+    queue->Push(*this);
   }
-  Valid(true);
+}
+
+void Metric::Notify(bool updated, bool changed) {
   if (updated) {
     SetUpdated();
+  } else if (changed) {
+    MarkChanged();
   }
 }
 
-template<>
-void Metric::Value(float value) {
+/** @brief In MQTT the value are sent as string value. Sometimes the value is
+ * appended with a unit string.
+ *
+ * The MQTT payload normally uses string values to send values. Sometimes a
+ * unit string is appended to the string. If the metric is a scalar type, the
+ * text is parsed into the native value and any trailing unit is ignored.
+ * Arrays are parsed as a comma separated list of values.
+ * @param text String value with optional unit
+ */
+void Metric::StoreText(std::string_view text) {
   bool updated = false;
+  bool changed = false;
   {
-    std::scoped_lock lock(metric_mutex_);
-    std::string new_value = FloatToString(value);
-    const auto pos = new_value.find(',');
-    if (pos != std::string::npos) {
-      new_value.replace(pos, 1, ".");
-    }
-    if (new_value != value_) {
-      updated = true;
-      value_ = std::move(new_value);
+    WriteLock lock(*this, true);
+    const bool valid = ParseLocked(DataType(), text, updated);
+    changed = ValidCell().exchange(valid) != valid;
+  }
+  Notify(updated, changed);
+}
+
+NativeValue Metric::LoadValue(MetricType type) const {
+  MetricType data_type = MetricType::String;
+  NativeValue value;
+  Slot().Load(data_type, value);
+  if (IsScalar(data_type)) {
+    return ConvertNative(data_type, type, value);
+  }
+
+  // Text and array values needs the lock. Note that the type may change
+  // meanwhile.
+  std::scoped_lock lock(metric_mutex_);
+  Slot().Load(data_type, value);
+  switch (KindOf(data_type)) {
+    case ValueKind::Text:
+      if (!StringToNative(type, text_, value)) {
+        value = NativeValue();
+      }
+      break;
+
+    case ValueKind::Array: {
+      // Returns the first element of the array
+      const MetricType element_type = ElementTypeOf(data_type);
+      if (element_type == MetricType::String) {
+        if (string_array_.empty() ||
+            !StringToNative(type, string_array_.front(), value)) {
+          value = NativeValue();
+        }
+      } else if (!array_.empty()) {
+        value = ConvertNative(element_type, type,
+                              LoadElement(element_type, array_.data()));
+      } else {
+        value = NativeValue();
+      }
+      break;
     }
+
+    default:
+      value = ConvertNative(data_type, type, value);
+      break;
   }
-  Valid(true);
-  if (updated) {
-    SetUpdated();
+  return value;
+}
+
+void Metric::StoreArray(MetricType type, const void* data, size_t count) {
+  bool updated = false;
+  bool changed = false;
+  {
+    WriteLock lock(*this, true);
+    bool valid = true;
+    if (const MetricType data_type = DataType();
+        KindOf(data_type) == ValueKind::Array &&
+        ElementTypeOf(data_type) != MetricType::String) {
+      updated = StoreArrayLocked(data_type, type, data, count);
+    } else {
+      valid = false;
+    }
+    changed = ValidCell().exchange(valid) != valid;
   }
+  Notify(updated, changed);
 }
 
-template<>
-void Metric::Value(double value) {
+void Metric::StoreStringArray(std::span<const std::string> values) {
   bool updated = false;
+  bool changed = false;
   {
-    std::scoped_lock lock(metric_mutex_);
-    std::string new_value = DoubleToString(value);
-    const auto pos = new_value.find(',');
-    if (pos != std::string::npos) {
-      new_value.replace(pos, 1, ".");
+    WriteLock lock(*this, true);
+    bool valid = true;
+    if (DataType() == MetricType::StringArray) {
+      if (!std::ranges::equal(values, string_array_)) {
+        updated = true;
+        string_array_.assign(values.begin(), values.end());
+      }
+    } else {
+      valid = false;
     }
-    if (new_value != value_) {
+    changed = ValidCell().exchange(valid) != valid;
+  }
+  Notify(updated, changed);
+}
+
+const void* Metric::ArrayDataLocked(MetricType type, size_t& count) const {
+  count = 0;
+  const MetricType element_type = ElementTypeOf(DataType());
+  if (element_type == MetricType::String ||
+      !IsSameLayout(element_type, type)) {
+    return nullptr;
+  }
+  count = array_.size() / SizeOf(element_type);
+  return array_.data();
+}
+
+size_t Metric::ArraySize() const {
+  std::scoped_lock lock(metric_mutex_);
+  const MetricType element_type = ElementTypeOf(DataType());
+  if (element_type == MetricType::Unknown) {
+    return 0;
+  }
+  return element_type == MetricType::String ?
+      string_array_.size() : array_.size() / SizeOf(element_type);
+}
+
+bool Metric::StoreArrayLocked(MetricType data_type, MetricType type,
+                              const void* data, size_t count) {
+  const MetricType element_type = ElementTypeOf(data_type);
+  const size_t element_size = SizeOf(element_type);
+  const size_t nof_bytes = count * element_size;
+  if (IsSameLayout(element_type, type)) {
+    // Same type. Compare and copy the memory as is.
+    if (array_.size() == nof_bytes &&
+        (nof_bytes == 0 || std::memcmp(array_.data(), data, nof_bytes) == 0)) {
+      return false;
+    }
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    array_.assign(bytes, bytes + nof_bytes);
+    return true;
+  }
+
+  // Convert element by element
+  bool updated = array_.size() != nof_bytes;
+  array_.resize(nof_bytes);
+  const size_t input_size = SizeOf(type);
+  const auto* input = static_cast<const uint8_t*>(data);
+  uint8_t* output = array_.data();
+  for (size_t index = 0; index < count; ++index) {
+    const NativeValue value = ConvertNative(type, element_type,
+        LoadElement(type, input + (index * input_size)));
+    uint8_t* element = output + (index * element_size);
+    if (!updated &&
+        IsSameNative(element_type, value, LoadElement(element_type, element))) {
+      continue;
+    }
+    updated = true;
+    StoreElement(element_type, value, element);
+  }
+  return updated;
+}
+
+bool Metric::ParseLocked(MetricType data_type, std::string_view text,
+                         bool& updated) {
+  switch (KindOf(data_type)) {
+    case ValueKind::Text:
+      if (text != text_) {
+        updated = true;
+        text_ = text;
+      }
+      return true;
+
+    case ValueKind::Array:
+      break;
+
+    default: {
+      NativeValue old_value;
+      NativeValue new_value;
+      if (!StringToNative(data_type, text, new_value)) {
+        return false;
+      }
+      Slot().Load(data_type, old_value);
+      if (UpdateLocked(data_type, old_value, new_value)) {
+        updated = true;
+      }
+      return true;
+    }
+  }
+
+  // Comma separated list of array elements
+  std::vector<std::string_view> list;
+  for (size_t start = 0; start < text.size();) {
+    size_t end = text.find(',', start);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    list.emplace_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+
+  const MetricType element_type = ElementTypeOf(data_type);
+  if (element_type == MetricType::String) {
+    if (!std::ranges::equal(list, string_array_)) {
       updated = true;
-      value_ = std::move(new_value);
+      string_array_.assign(list.begin(), list.end());
     }
+    return true;
   }
-  Valid(true);
-  if (updated) {
-    SetUpdated();
+
+  const size_t element_size = SizeOf(element_type);
+  std::vector<uint8_t> temp(list.size() * element_size);
+  for (size_t index = 0; index < list.size(); ++index) {
+    NativeValue value;
+    if (!StringToNative(element_type, list[index], value)) {
+      return false;
+    }
+    StoreElement(element_type, value, temp.data() + (index * element_size));
   }
+  if (temp != array_) {
+    updated = true;
+    array_ = std::move(temp);
+  }
+  return true;
 }
 
-template<>
-std::string Metric::Value() const {
-  std::scoped_lock lock(metric_mutex_);
-  return value_;
+std::string Metric::TextLocked(MetricType data_type, NativeValue value) const {
+  switch (KindOf(data_type)) {
+    case ValueKind::Text:
+      return text_;
+
+    case ValueKind::Array:
+      break;
+
+    default:
+      return NativeToString(data_type, value);
+  }
+
+  std::string text;
+  const MetricType element_type = ElementTypeOf(data_type);
+  if (element_type == MetricType::String) {
+    for (const std::string& element : string_array_) {
+      if (!text.empty()) {
+        text += ',';
+      }
+      text += element;
+    }
+    return text;
+  }
+
+  const size_t element_size = SizeOf(element_type);
+  for (size_t offset = 0; offset + element_size <= array_.size();
+       offset += element_size) {
+    if (offset > 0) {
+      text += ',';
+    }
+    NumberBuffer buffer;
+    text += NativeToChars(element_type,
+                          LoadElement(element_type, array_.data() + offset),
+                          buffer);
+  }
+  return text;
 }
 
 template<>
-int8_t Metric::Value() const {
-  int8_t temp = 0;
-  std::scoped_lock lock(metric_mutex_);
-  try {
-    temp = static_cast< int8_t>(std::stoi(value_));
-  } catch (const std::exception&) {
+void Metric::Value(std::string value) {
+  StoreText(value);
+}
 
-  }
-  return temp;
+template<>
+void Metric::Value(std::string_view value) {
+  StoreText(value);
 }
 
 template<>
-uint8_t Metric::Value() const {
-  uint8_t temp = 0;
-  std::scoped_lock lock(metric_mutex_);
-  try {
-    temp = static_cast< uint8_t>(std::stoul(value_));
-  } catch (const std::exception&) {
+void Metric::Value(const char* value) {
+  StoreText(value != nullptr ? std::string_view(value) : std::string_view());
+}
 
+template<>
+std::string Metric::Value() const {
+  MetricType data_type = MetricType::String;
+  NativeValue value;
+  Slot().Load(data_type, value);
+  if (IsScalar(data_type)) {
+    return NativeToString(data_type, value);
   }
-  return temp;
+  std::scoped_lock lock(metric_mutex_);
+  Slot().Load(data_type, value);
+  return TextLocked(data_type, value);
 }
 
-template<>
-bool Metric::Value() const {
+void Metric::Column(MetricColumns* columns, uint32_t row) {
   std::scoped_lock lock(metric_mutex_);
-  if (value_.empty()) {
-    return false;
-  }
-  switch (value_[0]) {
-    case 'Y':
-    case 'y':
-    case 'T':
-    case 't':
-    case '1':
-      return true;
+  MetricType type = MetricType::String;
+  NativeValue value;
+  Slot().Load(type, value);
+  const uint64_t timestamp = Timestamp();
+  const bool valid = IsValid();
+
+  MetricColumns::Chunk* chunk = columns != nullptr ? columns->Reserve(row)
+                                                   : nullptr;
+  column_ = chunk;
+  column_offset_ = chunk != nullptr ? MetricColumns::OffsetOf(row) : 0;
+  BeginWrite();
+  Slot().Store(type, value);
+  TimestampCell() = timestamp;
+  ValidCell() = valid;
+  EndWrite();
+  MarkChanged();
+}
 
-    default:
-      break;
+void Metric::Load(MetricType& type, NativeValue& value,
+                  std::string& text) const {
+  Slot().Load(type, value);
+  if (IsScalar(type)) {
+    text.clear();
+    return;
+  }
+  std::scoped_lock lock(metric_mutex_);
+  Slot().Load(type, value);
+  if (IsScalar(type)) {
+    text.clear();
+  } else {
+    text = TextLocked(type, value);
   }
-  return false;
 }
 
-void Metric::AddProperty(const MetricProperty& property) {
+void Metric::Load(MetricType& type, NativeValue& value, std::string& text,
+                  uint64_t& timestamp, bool& valid) const {
+  LoadSample(type, value, timestamp, valid);
+  if (IsScalar(type)) {
+    text.clear();
+    return;
+  }
+  // The writers of other types also hold the metric lock
   std::scoped_lock lock(metric_mutex_);
-  const std::string& key = property.Key();
-  if (auto exist = property_list_.find(key);
-      exist == property_list_.end()) {
-    property_list_.emplace(key, property);
+  LoadSample(type, value, timestamp, valid);
+  if (IsScalar(type)) {
+    text.clear();
   } else {
-    exist->second = property;
+    text = TextLocked(type, value);
   }
 }
 
-MetricProperty* Metric::CreateProperty(const std::string& key) {
-  std::scoped_lock lock(metric_mutex_);
-  if (const auto exist = property_list_.find(key);
-      exist == property_list_.cend()) {
-    MetricProperty temp;
-    temp.Key(key);
-    property_list_.emplace(key, temp);
+void Metric::LoadSample(MetricType& type, NativeValue& value,
+                        uint64_t& timestamp, bool& valid) const {
+  uint32_t sequence1 = 0;
+  uint32_t sequence2 = 0;
+  do {
+    sequence1 = write_sequence_.load(std::memory_order_acquire);
+    Slot().Load(type, value);
+    timestamp = TimestampCell().load(std::memory_order_relaxed);
+    valid = ValidCell().load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    sequence2 = write_sequence_.load(std::memory_order_relaxed);
+  } while (sequence1 != sequence2 || (sequence1 & 1) != 0);
+}
+
+void Metric::SetUpdated() {
+  updated_ = true;
+  MarkChanged();
+  if (MetricQueue* queue = queue_; queue != nullptr) {
+    queue->Push(*this);
   }
-  return GetProperty(key);
 }
 
-MetricProperty *Metric::GetProperty(const std::string &key) {
+std::shared_ptr<const MetricPropertyList> Metric::PublishPropertiesLocked(
+    MetricPropertyList list) {
+  auto current = std::make_shared<const MetricPropertyList>(std::move(list));
+  property_list_.store(current, std::memory_order_release);
+  return current;
+}
+
+void Metric::AddProperty(MetricProperty property) {
   std::scoped_lock lock(metric_mutex_);
-  if (auto exist = property_list_.find(key);
-      exist != property_list_.end()) {
-    return &exist->second;
-  }
-  return nullptr;
+  MetricPropertyList list = *Properties();
+  list.Insert(std::move(property));
+  PublishPropertiesLocked(std::move(list));
 }
 
-const MetricProperty *Metric::GetProperty(const std::string &key) const {
+std::shared_ptr<const MetricProperty> Metric::CreateProperty(
+    const std::string& key) {
   std::scoped_lock lock(metric_mutex_);
-  if (const auto exist = property_list_.find(key);
-      exist != property_list_.cend()) {
-    return &exist->second;
+  auto current = Properties();
+  if (const auto* exist = current->Find(key); exist != nullptr) {
+    return {std::move(current), exist};
+  }
+  MetricPropertyList list = *current;
+  MetricProperty temp;
+  temp.Key(key);
+  list.Insert(std::move(temp));
+  auto published = PublishPropertiesLocked(std::move(list));
+  const auto* property = published->Find(key);
+  return {std::move(published), property};
+}
+
+std::shared_ptr<const MetricProperty> Metric::GetProperty(
+    std::string_view key) const {
+  auto current = Properties();
+  if (const auto* property = current->Find(key); property != nullptr) {
+    return {std::move(current), property};
   }
   return nullptr;
 }
 
 void Metric::DeleteProperty(const std::string &key) {
   std::scoped_lock lock(metric_mutex_);
-  auto itr = property_list_.find(key);
-  if (itr != property_list_.end()) {
-    property_list_.erase(itr);
+  const auto current = Properties();
+  if (current->Find(key) == nullptr) {
+    return;
   }
+  MetricPropertyList list = *current;
+  list.Erase(key);
+  PublishPropertiesLocked(std::move(list));
 }
 
-void Metric::SetStringProperty(std::string key, std::string value) {
-  MetricProperty prop(std::move(key), std::move(value));
+void Metric::Properties(MetricPropertyList property_list) {
   std::scoped_lock lock(metric_mutex_);
-  AddProperty(prop);
+  PublishPropertiesLocked(std::move(property_list));
 }
 
-std::string Metric::GetStringProperty(const std::string &key) const {
-  std::scoped_lock lock(metric_mutex_);
-  if (const auto exist = property_list_.find(key);
-      exist != property_list_.cend() ) {
-    const auto& prop = exist->second;
-    try {
-      return prop.Value<std::string>();
-    } catch (const std::exception&) {
-      return {};
-    }
+void Metric::SetStringProperty(std::string_view key, std::string value) {
+  AddProperty(MetricProperty(key, std::move(value)));
+}
+
+std::string Metric::GetStringProperty(std::string_view key) const {
+  const auto current = Properties();
+  if (const auto* property = current->Find(key); property != nullptr) {
+    return property->Value<std::string>();
   }
   return {};
 }
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricarena.h"
+
+namespace metric {
+
+MetricArena::MetricArena(size_t initial_size)
+    : buffer_(initial_size) {
+}
+
+size_t MetricArena::FreeBlocks() const {
+  size_t count = 0;
+  for (const auto& [key, block_list] : free_list_) {
+    count += block_list.size();
+  }
+  return count;
+}
+
+void* MetricArena::Allocate(size_t size, size_t alignment) {
+  if (auto itr = free_list_.find({size, alignment});
+      itr != free_list_.end() && !itr->second.empty()) {
+    void* block = itr->second.back();
+    itr->second.pop_back();
+    return block;
+  }
+  allocated_ += size;
+  return buffer_.allocate(size, alignment);
+}
+
+void MetricArena::Deallocate(void* block, size_t size, size_t alignment) {
+  free_list_[{size, alignment}].push_back(block);
+}
+
+}  // namespace metric
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metriccolumns.h"
+
+namespace metric {
+
+MetricColumns::Chunk* MetricColumns::Reserve(uint32_t row) {
+  const size_t chunk_index = row / kChunkSize;
+  if (chunk_index >= kMaxChunks) {
+    return nullptr;
+  }
+  for (size_t index = nof_chunks_.load(std::memory_order_relaxed);
+       index <= chunk_index; ++index) {
+    chunk_list_[index] = std::make_unique<Chunk>();
+    nof_chunks_.store(index + 1, std::memory_order_release);
+  }
+  return chunk_list_[chunk_index].get();
+}
+
+void MetricColumns::Reset(uint32_t row) {
+  if (row >= Rows()) {
+    return;
+  }
+  Chunk& chunk = ChunkOf(row);
+  const uint32_t offset = OffsetOf(row);
+  chunk.value[offset].Store(MetricType::String, NativeValue());
+  chunk.timestamp[offset].store(0, std::memory_order_relaxed);
+  chunk.valid[offset].store(false, std::memory_order_relaxed);
+}
+
+}  // namespace metric
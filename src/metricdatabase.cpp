@@ -6,6 +6,10 @@
 #include <string>
 #include <array>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
 
 #include "metric/metricdatabase.h"
 
@@ -16,8 +20,8 @@ constexpr std::array<std::string_view, 4> kTypeList =
 
 
 struct {
-  bool operator()(const std::unique_ptr<metric::MetricGroup>& group1,
-                  const std::unique_ptr<metric::MetricGroup>& group2) const {
+  bool operator()(const metric::ArenaPtr<metric::MetricGroup>& group1,
+                  const metric::ArenaPtr<metric::MetricGroup>& group2) const {
     if (!group1) {
       return true;
     }
@@ -34,115 +38,627 @@ struct {
   }
 } SortGroup;
 
-struct {
-  bool operator()(const std::unique_ptr<metric::Metric>& metric1,
-                  const std::unique_ptr<metric::Metric>& metric2) const {
-    if (!metric1) {
+/** Returns the definitions in group order. The order within a group is
+ * kept, so the first of two duplicates is still created. */
+template <typename Definition>
+std::vector<Definition*> GroupOrder(std::span<Definition> definition_list) {
+  std::vector<Definition*> order_list;
+  order_list.reserve(definition_list.size());
+  for (Definition& definition : definition_list) {
+    order_list.push_back(&definition);
+  }
+  const auto less = [](const Definition* definition1,
+                       const Definition* definition2) {
+    if (definition1->group_identity != definition2->group_identity) {
+      return definition1->group_identity < definition2->group_identity;
+    }
+    return definition1->group_name < definition2->group_name;
+  };
+  if (!std::ranges::is_sorted(order_list, less)) {
+    std::ranges::stable_sort(order_list, less);
+  }
+  return order_list;
+}
+
+/** Returns the index after the definitions in the same group as index. */
+template <typename Definition>
+size_t GroupEnd(const std::vector<Definition*>& order_list, size_t index) {
+  const Definition* first = order_list[index];
+  while (index < order_list.size() &&
+         order_list[index]->group_identity == first->group_identity &&
+         order_list[index]->group_name == first->group_name) {
+    ++index;
+  }
+  return index;
+}
+
+/** Least number of metrics in a group block. The block of a group that is
+ * created metric by metric grows with the group. */
+constexpr size_t kMinGroupBlock = 4;
+
+uint64_t TimeNow() {
+  const auto now = std::chrono::system_clock::now();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          now.time_since_epoch()).count());
+}
+
+}
+
+namespace metric {
+
+void MetricDatabase::Enable(bool enable) {
+  enabled_ = enable;
+  operable_ = enable;
+}
+
+void MetricDatabase::Concurrent(bool concurrent) {
+  list_mutex_.Enable(concurrent);
+  group_mutex_.Enable(concurrent);
+  metric_index_.Concurrent(concurrent);
+}
+
+MetricGroup* MetricDatabase::CreateGroup(std::string name, int32_t identity) {
+  std::scoped_lock lock(list_mutex_);
+  return AddGroup(std::move(name), identity);
+}
+
+MetricGroup* MetricDatabase::AddGroup(std::string name, int32_t identity) {
+  if (std::shared_lock lock(group_mutex_);
+      auto* group = group_index_.Find(name, identity)) {
+    return group;
+  }
+  auto new_group = arena_.Create<MetricGroup>(string_pool_, arena_.Resource());
+  new_group->Name(std::move(name));
+  new_group->Identity(identity);
+  // Metrics that were created in a deleted group with the same key
+  for (Metric* metric : metric_order_.ByGroupName(new_group->Name())) {
+    if (metric->GroupIdentity() == identity) {
+      new_group->AddMetric(*metric);
+    }
+  }
+  {
+    std::scoped_lock lock(group_mutex_);
+    group_index_.Add(*new_group);
+  }
+  group_list_.emplace_back(std::move(new_group));
+  return group_list_.back().get();
+}
+
+void MetricDatabase::DeleteGroup(std::string_view name, uint32_t identity) {
+  std::scoped_lock lock(list_mutex_);
+  std::vector<ArenaPtr<MetricGroup>> remove_list;
+  std::erase_if(group_list_, [&](auto& group) -> bool {
+    if (!group) {
       return true;
     }
-    if (!metric2) {
+    if (group->Name() != name || group->Identity() != identity) {
       return false;
     }
-    if (metric1->GroupName() < metric2->GroupName()) {
-      return true;
+    std::scoped_lock index_lock(group_mutex_);
+    group_index_.Remove(*group);
+    remove_list.push_back(std::move(group));
+    return true;
+  });
+  if (remove_list.empty()) {
+    return;
+  }
+  // The metrics are kept and use their own lock until the group is created
+  // again
+  for (auto& group : remove_list) {
+    for (Metric* metric : group->Metrics()) {
+      metric->Group(nullptr);
+    }
+    ReleaseGroupBlock(*group);
+  }
+  const uint64_t epoch = epoch_.Advance();
+  for (auto& group : remove_list) {
+    retired_group_list_.push_back({epoch, std::move(group)});
+  }
+  ReclaimRetired();
+}
+
+Metric* MetricDatabase::CreateMetric(const MetricGroup& group,
+                                     std::string name) {
+  std::scoped_lock lock(list_mutex_);
+  if (auto* metric = metric_index_.Find(group.Name(), group.Identity(), name);
+      metric != nullptr) {
+    return metric;
+  }
+  return AddMetric(group, name);
+}
+
+Metric* MetricDatabase::AddMetric(const MetricGroup& group,
+                                  std::string_view name) {
+  Metric* metric = AddUnorderedMetric(group, name);
+  if (metric != nullptr) {
+    metric_order_.Add(*metric);
+  }
+  return metric;
+}
+
+Metric* MetricDatabase::AddUnorderedMetric(const MetricGroup& group,
+                                           std::string_view name) {
+  MetricGroup* owner = group_index_.Find(group.Name(), group.Identity());
+  ArenaPtr<Metric> new_metric;
+  if (owner != nullptr) {
+    ReserveGroup(*owner, 1);
+    new_metric = arena_.CreateAt<Metric>(owner->block_ + owner->block_used_,
+                                         group.Name(), group.Identity(), name,
+                                         string_pool_);
+    ++owner->block_used_;
+  } else {
+    new_metric = arena_.Create<Metric>(group.Name(), group.Identity(), name,
+                                       string_pool_);
+  }
+  const MetricHandle handle = AllocateHandle(*new_metric);
+  if (!handle.IsValid()) {
+    return nullptr;
+  }
+  new_metric->Queue(&update_queue_);
+  new_metric->Handle(handle);
+  if (columns_) {
+    new_metric->Column(columns_.get(), new_metric->Handle().Index());
+  }
+  if (change_set_) {
+    const uint32_t row = new_metric->Handle().Index();
+    change_set_->Reserve(row);
+    new_metric->ChangeSet(change_set_.get());
+    change_set_->Mark(row);
+  }
+  metric_index_.Add(*new_metric);
+  if (owner != nullptr) {
+    owner->AddMetric(*new_metric);
+  }
+  slot_list_[handle.Index()].position =
+      static_cast<uint32_t>(metric_list_.size());
+  metric_list_.emplace_back(std::move(new_metric));
+  return metric_list_.back().get();
+}
+
+void MetricDatabase::DeleteMetric(const MetricGroup& group, std::string name) {
+  std::scoped_lock lock(list_mutex_);
+  Metric* metric = metric_index_.Find(group.Name(), group.Identity(), name);
+  if (metric == nullptr) {
+    return;
+  }
+  // Unlink the metric, so no new reader can find it
+  metric_index_.Remove(*metric);
+  metric_order_.Remove(*metric);
+  if (auto* owner = group_index_.Find(metric->GroupName(),
+                                      metric->GroupIdentity());
+      owner != nullptr) {
+    owner->RemoveMetric(*metric);
+  }
+  const uint32_t position = slot_list_[metric->Handle().Index()].position;
+  ReleaseHandle(metric->Handle());
+  // A queued metric is dropped by the consumer, as only the consumer may
+  // unlink it
+  metric->Queue(nullptr);
+  if (change_set_) {
+    // The next snapshot clears the row
+    metric->ChangeSet(nullptr);
+    change_set_->Mark(metric->Handle().Index());
+  }
+  // The last metric takes the place of the deleted metric
+  if (position < metric_list_.size() &&
+      metric_list_[position].get() == metric) {
+    retired_metric_list_.push_back(
+        {epoch_.Advance(), std::move(metric_list_[position])});
+    if (position + 1 < metric_list_.size()) {
+      metric_list_[position] = std::move(metric_list_.back());
+      slot_list_[metric_list_[position]->Handle().Index()].position = position;
     }
-    if (metric1->GroupName() > metric2->GroupName()) {
+    metric_list_.pop_back();
+  }
+  ReclaimRetired();
+}
+
+void MetricDatabase::ReserveGroup(MetricGroup& group, size_t count) {
+  if (group.block_size_ - group.block_used_ >= count) {
+    return;
+  }
+  ReleaseGroupBlock(group);
+  const size_t size =
+      std::max({count, group.Metrics().size(), kMinGroupBlock});
+  group.block_ = arena_.AllocateArray<Metric>(size);
+  group.block_size_ = size;
+}
+
+void MetricDatabase::ReleaseGroupBlock(MetricGroup& group) {
+  for (size_t index = group.block_used_; index < group.block_size_; ++index) {
+    arena_.Release(group.block_ + index);
+  }
+  group.block_ = nullptr;
+  group.block_size_ = 0;
+  group.block_used_ = 0;
+}
+
+size_t MetricDatabase::Reclaim() {
+  std::scoped_lock lock(list_mutex_);
+  return ReclaimRetired();
+}
+
+size_t MetricDatabase::ReclaimRetired() {
+  size_t nof_freed = 0;
+  bool purged = false;
+  std::erase_if(retired_metric_list_, [&](auto& retired) -> bool {
+    if (!epoch_.IsSafe(retired.epoch)) {
       return false;
     }
-    if (metric1->GroupIdentity() < metric2->GroupIdentity()) {
-      return true;
+    // No writer can push the metric anymore, so a purge unlinks it also
+    // when nobody drains the queue
+    if (retired.object->IsQueued() && !purged) {
+      update_queue_.Purge();
+      purged = true;
     }
-    if (metric1->GroupIdentity() > metric2->GroupIdentity()) {
+    if (retired.object->IsQueued()) {
       return false;
     }
-    return metric1->Name() < metric2->Name();
+    // The handle slot and the column row may now be reused
+    const uint32_t row = retired.object->Handle().Index();
+    if (columns_) {
+      retired.object->Column(nullptr, 0);
+      columns_->Reset(row);
+    }
+    free_slot_list_.push_back(row);
+    ++nof_freed;
+    return true;
+  });
+  nof_freed += std::erase_if(retired_group_list_, [&](const auto& retired) {
+    return epoch_.IsSafe(retired.epoch);
+  });
+  return nof_freed;
+}
+
+size_t MetricDatabase::ImportMetrics(
+    std::span<const MetricDefinition> definition_list) {
+  std::scoped_lock lock(list_mutex_);
+  ReserveMetrics(definition_list.size());
+  size_t nof_created = 0;
+  const MetricGroup* group = nullptr;
+  const auto order_list = GroupOrder(definition_list);
+  size_t group_end = 0;
+  // The metrics of a group are added to the sorted order together
+  std::vector<Metric*> group_metrics;
+  for (size_t index = 0; index < order_list.size(); ++index) {
+    if (index == group_end) {
+      group_end = GroupEnd(order_list, index);
+    }
+    const MetricDefinition& definition = *order_list[index];
+    if (Metric* metric =
+            ImportMetric(group, group_end - index, definition,
+                         definition.unit, definition.description,
+                         definition.property_list);
+        metric != nullptr) {
+      group_metrics.push_back(metric);
+    }
+    if (index + 1 == group_end) {
+      nof_created += group_metrics.size();
+      metric_order_.Add(group_metrics);
+      group_metrics.clear();
+    }
   }
-} SortMetricByGroup;
+  return nof_created;
+}
 
-struct {
-  bool operator()(const std::unique_ptr<metric::Metric>& metric1,
-                  const std::unique_ptr<metric::Metric>& metric2) const {
-    if (!metric1) {
-      return true;
+size_t MetricDatabase::ImportMetrics(
+    std::vector<MetricDefinition>&& definition_list) {
+  std::scoped_lock lock(list_mutex_);
+  ReserveMetrics(definition_list.size());
+  size_t nof_created = 0;
+  const MetricGroup* group = nullptr;
+  const auto order_list =
+      GroupOrder(std::span<MetricDefinition>(definition_list));
+  size_t group_end = 0;
+  // The metrics of a group are added to the sorted order together
+  std::vector<Metric*> group_metrics;
+  for (size_t index = 0; index < order_list.size(); ++index) {
+    if (index == group_end) {
+      group_end = GroupEnd(order_list, index);
     }
-    if (!metric2) {
-      return false;
+    MetricDefinition& definition = *order_list[index];
+    if (Metric* metric = ImportMetric(group, group_end - index, definition,
+                                      std::move(definition.unit),
+                                      std::move(definition.description),
+                                      std::move(definition.property_list));
+        metric != nullptr) {
+      group_metrics.push_back(metric);
+    }
+    if (index + 1 == group_end) {
+      nof_created += group_metrics.size();
+      metric_order_.Add(group_metrics);
+      group_metrics.clear();
     }
-    return metric1->Name() < metric2->Name();
   }
-} SortMetricByName;
+  definition_list.clear();
+  return nof_created;
+}
 
-struct {
-  bool operator()(const metric::Metric* metric1,
-                  const metric::Metric* metric2) const {
-    if (metric1 == nullptr) {
-      return true;
+void MetricDatabase::ReserveMetrics(size_t count) {
+  const size_t nof_metrics = metric_list_.size() + count;
+  metric_list_.reserve(nof_metrics);
+  slot_list_.Reserve(nof_metrics);
+  metric_index_.Reserve(nof_metrics);
+  // One name per metric at most, the group names are few
+  string_pool_.Reserve(count);
+}
+
+Metric* MetricDatabase::ImportMetric(const MetricGroup*& group,
+                                     size_t group_size,
+                                     const MetricDefinition& definition,
+                                     std::string unit,
+                                     std::string description,
+                                     MetricPropertyList property_list) {
+  // The definitions are sorted by group, so the block of a group is
+  // reserved once for all its definitions
+  if (group == nullptr || group->Identity() != definition.group_identity ||
+      group->Name() != definition.group_name) {
+    MetricGroup* owner =
+        AddGroup(definition.group_name, definition.group_identity);
+    ReserveGroup(*owner, group_size);
+    group = owner;
+  }
+  if (metric_index_.Find(group->Name(), group->Identity(), definition.name) !=
+      nullptr) {
+    return nullptr;
+  }
+  Metric* metric = AddUnorderedMetric(*group, definition.name);
+  if (metric == nullptr) {
+    return nullptr;
+  }
+  if (definition.data_type != MetricType::Unknown) {
+    metric->DataType(definition.data_type);
+  }
+  if (!unit.empty() || !description.empty() || !property_list.empty()) {
+    // Publish all properties as one list
+    if (!unit.empty()) {
+      property_list.Insert(MetricProperty("unit", std::move(unit)));
     }
-    if (metric2 == nullptr) {
-      return false;
+    if (!description.empty()) {
+      property_list.Insert(
+          MetricProperty("description", std::move(description)));
     }
-    return metric1->Name() < metric2->Name();
+    metric->Properties(std::move(property_list));
   }
-} SortMetricByNamePointer;
+  return metric;
+}
 
+MetricHandle MetricDatabase::AllocateHandle(Metric& metric) {
+  uint32_t index = 0;
+  if (free_slot_list_.empty()) {
+    if (!slot_list_.Append(index)) {
+      return {};
+    }
+  } else {
+    index = free_slot_list_.back();
+    free_slot_list_.pop_back();
+  }
+  HandleTable::Slot& slot = slot_list_[index];
+  slot.metric.store(&metric, std::memory_order_release);
+  return {index, slot.generation.load(std::memory_order_relaxed)};
 }
 
-namespace metric {
+void MetricDatabase::ReleaseHandle(MetricHandle handle) {
+  if (GetMetric(handle) == nullptr) {
+    return;
+  }
+  HandleTable::Slot& slot = slot_list_[handle.Index()];
+  slot.metric.store(nullptr, std::memory_order_release);
+  // Skip generation 0 as it is an invalid handle
+  uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+  if (generation == 0) {
+    generation = 1;
+  }
+  slot.generation.store(generation, std::memory_order_release);
+  // The index is reused when the metric has been reclaimed
+}
 
-void MetricDatabase::Enable(bool enable) {
-  enabled_ = enable;
-  operable_ = enable;
+Metric* MetricDatabase::GetMetric(MetricHandle handle) const {
+  if (handle.Index() >= slot_list_.Size()) {
+    return nullptr;
+  }
+  const HandleTable::Slot& slot = slot_list_[handle.Index()];
+  Metric* metric = slot.metric.load(std::memory_order_acquire);
+  return slot.generation.load(std::memory_order_acquire) ==
+                 handle.Generation()
+             ? metric
+             : nullptr;
 }
 
-MetricGroup* MetricDatabase::CreateGroup(std::string name, int32_t identity) {
-  auto itr = std::ranges::find_if(group_list_, [&](const auto& group) -> bool {
-    return group && group->Name() == name && group->Identity() == identity;
-  });
-  if (itr == group_list_.end()) {
-    if (auto new_group = std::make_unique<MetricGroup>(); new_group) {
-      new_group->Name(std::move(name));
-      new_group->Identity(identity);
-      group_list_.emplace_back(std::move(new_group));
-    } else {
-      return itr->get();
+void MetricDatabase::Columnar(bool columnar) {
+  std::scoped_lock lock(list_mutex_);
+  if (columnar == IsColumnar()) {
+    return;
+  }
+  if (columnar) {
+    columns_ = std::make_unique<MetricColumns>();
+  }
+  for (auto& metric : metric_list_) {
+    if (metric) {
+      metric->Column(columnar ? columns_.get() : nullptr,
+                     metric->Handle().Index());
     }
   }
-  return group_list_.back().get();
+  for (auto& retired : retired_metric_list_) {
+    // The deleted metrics still owns their rows
+    retired.object->Column(columnar ? columns_.get() : nullptr,
+                           retired.object->Handle().Index());
+  }
+  if (!columnar) {
+    columns_.reset();
+  }
 }
 
-void MetricDatabase::DeleteGroup(std::string name, uint32_t identity) {
-  std::erase_if(group_list_, [&](const auto& group) -> bool {
-    return !group || (group->Name() == name && group->Identity() == identity);
+std::shared_ptr<const MetricSnapshot> MetricDatabase::Snapshot() {
+  std::scoped_lock lock(snapshot_mutex_);
+  std::shared_lock list_lock(list_mutex_);
+  if (!change_set_) {
+    change_set_ = std::make_unique<MetricChangeSet>();
+    for (uint32_t row = 0; row < slot_list_.Size(); ++row) {
+      change_set_->Reserve(row);
+      change_set_->Mark(row);
+    }
+    // Attach after the rows exist, as a metric marks its row when updated
+    for (auto& metric : metric_list_) {
+      if (metric) {
+        metric->ChangeSet(change_set_.get());
+      }
+    }
+  }
+
+  using Page = MetricSnapshot::Page;
+  using PageChunk = MetricSnapshot::PageChunk;
+  constexpr size_t kPageSize = MetricSnapshot::kPageSize;
+  constexpr size_t kChunkSize = MetricSnapshot::kChunkSize;
+
+  // Only the page table chunks are copied, not the page table
+  auto snapshot = std::make_shared<MetricSnapshot>();
+  if (snapshot_) {
+    snapshot->chunk_list_ = snapshot_->chunk_list_;
+  }
+  const size_t nof_pages = (slot_list_.Size() + kPageSize - 1) / kPageSize;
+  const bool resized = !snapshot_ || snapshot_->nof_pages_ != nof_pages;
+  snapshot->nof_pages_ = nof_pages;
+  snapshot->chunk_list_.resize((nof_pages + kChunkSize - 1) / kChunkSize);
+
+  // The rows are drained in increasing order, so the page and chunk that
+  // are copied by this snapshot are the last ones written.
+  size_t chunk_index = std::numeric_limits<size_t>::max();
+  PageChunk* chunk = nullptr;
+  size_t page_index = std::numeric_limits<size_t>::max();
+  Page* page = nullptr;
+  std::string text;
+  const size_t nof_changes = change_set_->Drain([&](uint32_t row) {
+    if (row / kPageSize >= nof_pages) {
+      return;
+    }
+    if (row / kPageSize != page_index) {
+      page_index = row / kPageSize;
+      if (page_index / kChunkSize != chunk_index) {
+        chunk_index = page_index / kChunkSize;
+        const auto& old_chunk = snapshot->chunk_list_[chunk_index];
+        auto new_chunk = old_chunk ? std::make_shared<PageChunk>(*old_chunk)
+                                   : std::make_shared<PageChunk>();
+        chunk = new_chunk.get();
+        snapshot->chunk_list_[chunk_index] = std::move(new_chunk);
+      }
+      auto& page_ptr = (*chunk)[page_index % kChunkSize];
+      auto new_page = page_ptr ? std::make_shared<Page>(*page_ptr)
+                               : std::make_shared<Page>();
+      page = new_page.get();
+      page_ptr = std::move(new_page);
+    }
+
+    SnapshotValue& item = (*page)[row % kPageSize];
+    const Metric* metric = row < slot_list_.Size()
+                               ? slot_list_[row].metric.load()
+                               : nullptr;
+    if (metric == nullptr) {
+      item = SnapshotValue();
+      return;
+    }
+    item.handle = metric->Handle();
+    metric->Load(item.type, item.value, text, item.timestamp, item.valid);
+    if (IsScalar(item.type)) {
+      item.text.reset();
+    } else if (!item.text || *item.text != text) {
+      item.text = std::make_shared<const std::string>(text);
+    }
   });
+
+  if (!resized && nof_changes == 0) {
+    return snapshot_;
+  }
+  snapshot->version_ = snapshot_ ? snapshot_->Version() + 1 : 1;
+  snapshot_ = std::move(snapshot);
+  return snapshot_;
 }
 
-Metric* MetricDatabase::CreateMetric(const MetricGroup& group,
-                                     std::string name) {
-  auto itr =
-      std::ranges::find_if(metric_list_, [&](const auto& metric) -> bool {
-        return metric && group.Name() == metric->GroupName() &&
-               group.Identity() == metric->GroupIdentity() &&
-               metric->Name() == name;
-      });
-  if (itr == metric_list_.end()) {
-    if (auto new_metric = std::make_unique<Metric>(); new_metric) {
-      new_metric->Name(std::move(name));
-      new_metric->GroupName(group.Name());
-      new_metric->GroupIdentity(group.Identity());
-      metric_list_.emplace_back(std::move(new_metric));
-    } else {
-      return itr->get();
+size_t MetricDatabase::DrainUpdated(std::vector<Metric*>& dest) {
+  return update_queue_.Drain(dest);
+}
+
+size_t MetricDatabase::UpdateBatch(std::span<const MetricUpdate> update_list) {
+  // A metric that is deleted meanwhile is freed after the batch
+  const auto guard = epoch_.Pin();
+  const uint64_t batch_time = TimeNow();
+
+  size_t nof_changes = 0;
+  for (const MetricUpdate& update : update_list) {
+    Metric* metric = GetMetric(update.handle);
+    if (metric == nullptr) {
+      continue;
+    }
+    if (metric->Update(update.timestamp > 0 ? update.timestamp : batch_time,
+                       update.type, update.value)) {
+      ++nof_changes;
     }
   }
-  return metric_list_.back().get();
+  if (nof_changes > 0) {
+    OnUpdate(nof_changes);
+  }
+  return nof_changes;
 }
 
-void MetricDatabase::DeleteMetric(const MetricGroup& group, std::string name) {
-  std::erase_if(metric_list_, [&](const auto& metric) -> bool {
-    return !metric || (metric->GroupName() == group.Name() &&
-                       metric->GroupIdentity() == group.Identity() &&
-                       metric->Name() == name);
-  });
+size_t MetricDatabase::UpdateGroup(MetricGroup& group,
+                                   std::span<const MetricUpdate> update_list,
+                                   uint64_t timestamp) {
+  const auto guard = epoch_.Pin();
+  const uint64_t frame_time = timestamp > 0 ? timestamp : TimeNow();
+  size_t nof_changes = 0;
+  group.BeginUpdate();
+  for (const MetricUpdate& update : update_list) {
+    // A metric that leaves the group waits for the frame to end
+    if (Metric* metric = GetMetric(update.handle);
+        metric != nullptr && metric->Group() == &group &&
+        metric->WriteFrame(frame_time, update.type, update.value)) {
+      ++nof_changes;
+    }
+  }
+  group.EndUpdate(frame_time);
+  for (const MetricUpdate& update : update_list) {
+    if (Metric* metric = GetMetric(update.handle);
+        metric != nullptr && metric->Group() == &group) {
+      metric->PublishFrame();
+    }
+  }
+  if (nof_changes > 0) {
+    OnUpdate(nof_changes);
+  }
+  return nof_changes;
+}
+
+size_t MetricDatabase::ReadGroup(const MetricGroup& group,
+                                 std::vector<SnapshotValue>& dest) const {
+  {
+    std::shared_lock lock(list_mutex_);
+    const auto metric_list = group.Metrics();
+    dest.resize(metric_list.size());
+    for (size_t index = 0; index < metric_list.size(); ++index) {
+      dest[index].handle = metric_list[index]->Handle();
+    }
+  }
+  // A metric that is deleted meanwhile is read as an invalid value
+  const auto guard = epoch_.Pin();
+  uint64_t sequence = 0;
+  do {
+    sequence = group.ReadBegin();
+    for (SnapshotValue& item : dest) {
+      const Metric* metric = GetMetric(item.handle);
+      if (metric == nullptr) {
+        item.type = MetricType::Unknown;
+        item.value = NativeValue();
+        item.timestamp = 0;
+        item.valid = false;
+        continue;
+      }
+      metric->Load(item.type, item.value);
+      item.timestamp = metric->Timestamp();
+      item.valid = metric->IsValid();
+    }
+  } while (group.ReadRetry(sequence));
+  return dest.size();
 }
 
 std::string_view MetricDatabase::TypeToString(TypeOfDatabase type) {
@@ -165,93 +681,98 @@ TypeOfDatabase MetricDatabase::TypeFromString(const std::string& type) {
   return TypeOfDatabase::Unknown;
 }
 
-MetricGroup* MetricDatabase::GetGroupByName(const std::string& name) const {
-  auto itr =
-      std::ranges::find_if(group_list_, [&name](const auto& group) -> bool {
-        return group && group->Name() == name;
-      });
-  return itr != group_list_.end() ? itr->get() : nullptr;
+MetricGroup* MetricDatabase::GetGroupByName(std::string_view name) const {
+  std::shared_lock lock(group_mutex_);
+  return group_index_.Find(name);
 }
 
 MetricGroup* MetricDatabase::GetGroupByIdentity(int64_t identity) const {
-  auto itr =
-      std::ranges::find_if(group_list_, [&identity](const auto& group) -> bool {
-        return group && group->Identity() == identity;
-      });
-  return itr != group_list_.end() ? itr->get() : nullptr;
+  std::shared_lock lock(group_mutex_);
+  return group_index_.Find(identity);
 }
 
 Metric* MetricDatabase::GetMetricByGroupName(
-    const std::string& group_name, const std::string& metric_name) const {
-  auto itr =
-      std::ranges::find_if(metric_list_, [&](const auto& metric) -> bool {
-        return metric && metric->GroupName() == group_name &&
-               metric->Name() == metric_name;
-      });
-  return itr != metric_list_.end() ? itr->get() : nullptr;
+    std::string_view group_name, std::string_view metric_name) const {
+  return metric_index_.Find(group_name, metric_name);
 }
 
 Metric* MetricDatabase::GetMetricByGroupIdentity(
-    int64_t group_identity, const std::string& metric_name) const {
-  auto itr =
-      std::ranges::find_if(metric_list_, [&](const auto& metric) -> bool {
-        return metric && metric->GroupIdentity() == group_identity &&
-               metric->Name() == metric_name;
-      });
-  return itr != metric_list_.end() ? itr->get() : nullptr;
+    int64_t group_identity, std::string_view metric_name) const {
+  return metric_index_.Find(group_identity, metric_name);
 }
 
 void MetricDatabase::SortGroups() {
+  std::scoped_lock lock(list_mutex_);
   std::ranges::sort(group_list_, SortGroup);
 }
 
 void MetricDatabase::SortMetricsByGroup() {
-  std::ranges::sort(metric_list_, SortMetricByGroup);
+  std::scoped_lock lock(list_mutex_);
+  ReorderMetrics(metric_order_.ByGroup());
 }
 
 void MetricDatabase::SortMetricsByName() {
-  std::ranges::sort(metric_list_, SortMetricByName);
+  std::scoped_lock lock(list_mutex_);
+  ReorderMetrics(metric_order_.ByName());
 }
 
-std::vector<Metric*> MetricDatabase::MetricsByName() const {
-  std::vector<Metric*> dest_list;
-  dest_list.reserve(metric_list_.size());
-  for (const auto& metric : metric_list_) {
-    if (!metric) {
-      continue;
+template <typename Range>
+void MetricDatabase::ReorderMetrics(const Range& range) {
+  // The index holds the same metrics as the list, so the ownership is
+  // released and taken back in index order.
+  for (auto& metric : metric_list_) {
+    static_cast<void>(metric.release());
+  }
+  metric_list_.clear();
+  for (Metric* metric : range) {
+    slot_list_[metric->Handle().Index()].position =
+        static_cast<uint32_t>(metric_list_.size());
+    metric_list_.emplace_back(metric, ArenaDelete<Metric>{&arena_});
+  }
+}
+
+std::vector<MetricGroup*> MetricDatabase::GroupList() const {
+  std::shared_lock lock(list_mutex_);
+  std::vector<MetricGroup*> list;
+  list.reserve(group_list_.size());
+  for (const auto& group : group_list_) {
+    if (group) {
+      list.push_back(group.get());
     }
-    dest_list.emplace_back(metric.get());
   }
-  std::ranges::sort(dest_list, SortMetricByNamePointer);
-  return dest_list;
+  return list;
 }
 
-std::vector<Metric*> MetricDatabase::MetricsByGroupName(
-    const std::string& group_name) const {
-  std::vector<Metric*> dest_list;
+std::vector<Metric*> MetricDatabase::MetricList() const {
+  std::shared_lock lock(list_mutex_);
+  std::vector<Metric*> list;
+  list.reserve(metric_list_.size());
   for (const auto& metric : metric_list_) {
-    if (!metric ||
-        metric->GroupName() != group_name) {
-      continue;
+    if (metric) {
+      list.push_back(metric.get());
     }
-    dest_list.emplace_back(metric.get());
   }
-  std::ranges::sort(dest_list, SortMetricByNamePointer);
-  return dest_list;
+  return list;
+}
+
+std::vector<Metric*> MetricDatabase::MetricsByName() const {
+  std::shared_lock lock(list_mutex_);
+  const auto range = metric_order_.ByName();
+  return {range.begin(), range.end()};
+}
+
+std::vector<Metric*> MetricDatabase::MetricsByGroupName(
+    std::string_view group_name) const {
+  std::shared_lock lock(list_mutex_);
+  const auto range = metric_order_.ByGroupName(group_name);
+  return {range.begin(), range.end()};
 }
 
 std::vector<Metric*> MetricDatabase::MetricsByGroupIdentity(
     int64_t group_identity) const {
-  std::vector<Metric*> dest_list;
-  for (const auto& metric : metric_list_) {
-    if (!metric ||
-        metric->GroupIdentity() != group_identity) {
-      continue;
-    }
-    dest_list.emplace_back(metric.get());
-  }
-  std::ranges::sort(dest_list, SortMetricByNamePointer);
-  return dest_list;
+  std::shared_lock lock(list_mutex_);
+  const auto range = metric_order_.ByGroupIdentity(group_identity);
+  return {range.begin(), range.end()};
 }
 
 }  // namespace metric
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricepoch.h"
+
+#include <functional>
+#include <thread>
+
+namespace metric {
+
+MetricEpoch::Guard::Guard(MetricEpoch& epoch)
+    : epoch_(epoch),
+      slot_(epoch.Enter()) {
+}
+
+MetricEpoch::Guard::~Guard() {
+  epoch_.Leave(slot_);
+}
+
+size_t MetricEpoch::Enter() {
+  // Start the search at a slot given by the thread, so threads seldom
+  // compete for the same slot.
+  size_t index =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % kMaxReaders;
+  for (size_t tries = 1;; ++tries) {
+    ReaderSlot& slot = slot_list_[index];
+    if (bool expected = false;
+        !slot.used.load(std::memory_order_relaxed) &&
+        slot.used.compare_exchange_strong(expected, true,
+                                          std::memory_order_acquire)) {
+      break;
+    }
+    index = (index + 1) % kMaxReaders;
+    if (tries % kMaxReaders == 0) {
+      std::this_thread::yield(); // All slots are in use
+    }
+  }
+
+  // Announce the epoch and verify that it didn't advance meanwhile, so a
+  // writer either sees the announcement or the reader sees the unlink.
+  ReaderSlot& slot = slot_list_[index];
+  uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+  for (;;) {
+    slot.epoch.store(epoch, std::memory_order_seq_cst);
+    const uint64_t current = epoch_.load(std::memory_order_seq_cst);
+    if (current == epoch) {
+      break;
+    }
+    epoch = current;
+  }
+  return index;
+}
+
+void MetricEpoch::Leave(size_t slot) {
+  slot_list_[slot].epoch.store(kIdle, std::memory_order_release);
+  slot_list_[slot].used.store(false, std::memory_order_release);
+}
+
+bool MetricEpoch::IsSafe(uint64_t retire_epoch) const {
+  for (const ReaderSlot& slot : slot_list_) {
+    if (const uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+        epoch != kIdle && epoch <= retire_epoch) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t MetricEpoch::Readers() const {
+  size_t count = 0;
+  for (const ReaderSlot& slot : slot_list_) {
+    if (slot.epoch.load(std::memory_order_acquire) != kIdle) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+}  // namespace metric
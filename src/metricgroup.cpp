@@ -5,4 +5,82 @@
 
 #include "metric/metricgroup.h"
 
-namespace metric {}  // namespace metric
\ No newline at end of file
+#include <thread>
+
+#include "metric/metric.h"
+
+namespace metric {
+
+MetricGroup::MetricGroup(StringPool& pool, std::pmr::memory_resource* resource)
+    : string_pool_(&pool),
+      metric_list_(resource) {
+}
+
+MetricGroup::~MetricGroup() {
+  string_pool_->Release(name_);
+  string_pool_->Release(description_);
+}
+
+void MetricGroup::Name(std::string_view name) {
+  const std::string_view old_name = name_;
+  name_ = string_pool_->Intern(name);
+  string_pool_->Release(old_name);
+}
+
+void MetricGroup::Description(std::string_view desc) {
+  const std::string_view old_desc = description_;
+  description_ = string_pool_->Intern(desc);
+  string_pool_->Release(old_desc);
+}
+
+void MetricGroup::AddMetric(Metric& metric) {
+  metric_list_.push_back(&metric);
+  metric.Group(this);
+}
+
+void MetricGroup::RemoveMetric(Metric& metric) {
+  if (std::erase(metric_list_, &metric) > 0 && metric.Group() == this) {
+    metric.Group(nullptr);
+  }
+}
+
+void MetricGroup::BeginUpdate() {
+  uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  while (true) {
+    if ((sequence & 1) == 0 &&
+        sequence_.compare_exchange_weak(sequence, sequence + 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      break;
+    }
+    std::this_thread::yield();
+    sequence = sequence_.load(std::memory_order_relaxed);
+  }
+  // The values must not be written before the sequence is odd
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void MetricGroup::EndUpdate(uint64_t timestamp) {
+  timestamp_.store(timestamp, std::memory_order_relaxed);
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+void MetricGroup::EndUpdate() {
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t MetricGroup::ReadBegin() const {
+  uint64_t sequence = sequence_.load(std::memory_order_acquire);
+  while ((sequence & 1) != 0) {
+    std::this_thread::yield();
+    sequence = sequence_.load(std::memory_order_acquire);
+  }
+  return sequence;
+}
+
+bool MetricGroup::ReadRetry(uint64_t sequence) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence_.load(std::memory_order_relaxed) != sequence;
+}
+
+}  // namespace metric
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metrichandle.h"
+
+#include <algorithm>
+
+namespace metric {
+
+bool HandleTable::Append(uint32_t& index) {
+  const size_t size = size_.load(std::memory_order_relaxed);
+  const size_t chunk_index = size / kChunkSize;
+  if (chunk_index >= kMaxChunks) {
+    return false;
+  }
+  if (!chunk_list_[chunk_index]) {
+    chunk_list_[chunk_index] = std::make_unique<Chunk>();
+  }
+  index = static_cast<uint32_t>(size);
+  size_.store(size + 1, std::memory_order_release);
+  return true;
+}
+
+void HandleTable::Reserve(size_t count) {
+  const size_t nof_chunks = std::min((count + kChunkSize - 1) / kChunkSize,
+                                     kMaxChunks);
+  for (size_t index = 0; index < nof_chunks; ++index) {
+    if (!chunk_list_[index]) {
+      chunk_list_[index] = std::make_unique<Chunk>();
+    }
+  }
+}
+
+}  // namespace metric
@@ -3,15 +3,167 @@
 * SPDX-License-Identifier: MIT
 */
 
-#include <format>
 #include "metrichelper.h"
 
+#include <cstring>
+
 namespace metric {
+
+std::string_view NativeToChars(MetricType type, NativeValue value,
+                               NumberBuffer& buffer) {
+  switch (KindOf(type)) {
+    case ValueKind::Signed:
+      return NumberToChars(value.signed_value, buffer);
+
+    case ValueKind::Unsigned:
+      return NumberToChars(value.unsigned_value, buffer);
+
+    case ValueKind::Float:
+      return NumberToChars(value.float_value, buffer);
+
+    case ValueKind::Double:
+      return NumberToChars(value.double_value, buffer);
+
+    case ValueKind::Boolean:
+      return NumberToChars(value.bool_value, buffer);
+
+    default:
+      break;
+  }
+  return {};
+}
+
+NativeValue LoadElement(MetricType type, const void* data) {
+  NativeValue value;
+  switch (type) {
+    case MetricType::Int8: {
+      int8_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.signed_value = temp;
+      break;
+    }
+
+    case MetricType::Int16: {
+      int16_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.signed_value = temp;
+      break;
+    }
+
+    case MetricType::Int32: {
+      int32_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.signed_value = temp;
+      break;
+    }
+
+    case MetricType::UInt8: {
+      uint8_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.unsigned_value = temp;
+      break;
+    }
+
+    case MetricType::UInt16: {
+      uint16_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.unsigned_value = temp;
+      break;
+    }
+
+    case MetricType::UInt32: {
+      uint32_t temp = 0;
+      std::memcpy(&temp, data, sizeof(temp));
+      value.unsigned_value = temp;
+      break;
+    }
+
+    case MetricType::Float:
+      std::memcpy(&value.float_value, data, sizeof(float));
+      break;
+
+    case MetricType::Boolean:
+      std::memcpy(&value.bool_value, data, sizeof(bool));
+      break;
+
+    case MetricType::Int64:
+    case MetricType::UInt64:
+    case MetricType::Double:
+    case MetricType::DateTime:
+      std::memcpy(&value, data, sizeof(value));
+      break;
+
+    default:
+      break;
+  }
+  return value;
+}
+
+void StoreElement(MetricType type, NativeValue value, void* data) {
+  switch (type) {
+    case MetricType::Int8: {
+      const auto temp = static_cast<int8_t>(value.signed_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::Int16: {
+      const auto temp = static_cast<int16_t>(value.signed_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::Int32: {
+      const auto temp = static_cast<int32_t>(value.signed_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::UInt8: {
+      const auto temp = static_cast<uint8_t>(value.unsigned_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::UInt16: {
+      const auto temp = static_cast<uint16_t>(value.unsigned_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::UInt32: {
+      const auto temp = static_cast<uint32_t>(value.unsigned_value);
+      std::memcpy(data, &temp, sizeof(temp));
+      break;
+    }
+
+    case MetricType::Float:
+      std::memcpy(data, &value.float_value, sizeof(float));
+      break;
+
+    case MetricType::Boolean:
+      std::memcpy(data, &value.bool_value, sizeof(bool));
+      break;
+
+    case MetricType::Int64:
+    case MetricType::UInt64:
+    case MetricType::Double:
+    case MetricType::DateTime:
+      std::memcpy(data, &value, sizeof(value));
+      break;
+
+    default:
+      break;
+  }
+}
+
 std::string FloatToString(float value) {
-  return std::format("{}", value);
+  NumberBuffer buffer;
+  return std::string(NumberToChars(value, buffer));
 }
 
 std::string DoubleToString(double value) {
-  return std::format("{}", value);
+  NumberBuffer buffer;
+  return std::string(NumberToChars(value, buffer));
 }
-}  // namespace metric
\ No newline at end of file
+}  // namespace metric
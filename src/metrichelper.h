@@ -5,8 +5,106 @@
 
 #pragma once
 
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "metric/metricvalue.h"
+
 namespace metric {
+
+/** \brief Stack buffer that is large enough for any number as text.
+ *
+ * The longest shortest round-trip text of a double is 24 characters.
+ */
+using NumberBuffer = std::array<char, 32>;
+
+/** \brief Converts a number to text without any allocation.
+ *
+ * The conversion is locale independent, i.e. the decimal point is always
+ * a '.'. Floating point values uses the shortest text that converts back
+ * to the same value, so no precision is lost.
+ * @tparam T Arithmetic type.
+ * @param value Value to convert.
+ * @param buffer Buffer that holds the text.
+ * @return View of the text inside the buffer.
+ */
+template <typename T>
+[[nodiscard]] std::string_view NumberToChars(T value, NumberBuffer& buffer) {
+  static_assert(std::is_arithmetic_v<T>, "Only numbers are supported");
+  if constexpr (std::is_same_v<T, bool>) {
+    buffer[0] = value ? '1' : '0';
+    return {buffer.data(), 1};
+  } else {
+    const auto [end, error] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    return error == std::errc() ?
+        std::string_view(buffer.data(), end - buffer.data()) :
+        std::string_view();
+  }
+}
+
+/** \brief Parses a number from a text without any allocation.
+ *
+ * The parsing is locale independent. Leading white spaces and a leading '+'
+ * are skipped. Trailing text, for example a unit, is ignored.
+ * @tparam T Arithmetic type but not bool.
+ * @param text Text to parse.
+ * @param value Destination. Unchanged if the text isn't a valid number.
+ * @return True if a number was found.
+ */
+template <typename T>
+[[nodiscard]] bool CharsToNumber(std::string_view text, T& value) {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                "Only numbers are supported");
+  size_t first = 0;
+  while (first < text.size() &&
+         std::isspace(static_cast<unsigned char>(text[first])) != 0) {
+    ++first;
+  }
+  if (first < text.size() && text[first] == '+') {
+    ++first;
+  }
+  T temp = {};
+  const auto [end, error] =
+      std::from_chars(text.data() + first, text.data() + text.size(), temp);
+  if (error != std::errc()) {
+    return false;
+  }
+  value = temp;
+  return true;
+}
+
+/** \brief Converts a native value to text without any allocation.
+ *
+ * @param type Type of the native value.
+ * @param value Native value.
+ * @param buffer Buffer that holds the text.
+ * @return View of the text inside the buffer. Empty for non-scalar types.
+ */
+[[nodiscard]] std::string_view NativeToChars(MetricType type, NativeValue value,
+                                             NumberBuffer& buffer);
+
+/** \brief Reads an array element from memory.
+ *
+ * @param type Element type.
+ * @param data Pointer to the element.
+ * @return The element as a native value.
+ */
+[[nodiscard]] NativeValue LoadElement(MetricType type, const void* data);
+
+/** \brief Writes an array element to memory.
+ *
+ * @param type Element type.
+ * @param value Native value of the element type.
+ * @param data Pointer to the element.
+ */
+void StoreElement(MetricType type, NativeValue value, void* data);
+
 /** \brief Converts a float to string without loosing precision.
  *
  * Converts a float value to a string without loosing any precision.
@@ -23,4 +121,3 @@ namespace metric {
  */
 [[nodiscard]] std::string DoubleToString(double value);
 }  // namespace metric
-
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metrichistory.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace metric {
+
+MetricHistory::MetricHistory(size_t capacity)
+    : capacity_(std::max(capacity, size_t{1})),
+      slot_list_(std::make_unique<Slot[]>(capacity_)) {
+}
+
+size_t MetricHistory::Size() const {
+  return static_cast<size_t>(std::min<uint64_t>(Count(), capacity_));
+}
+
+void MetricHistory::Append(uint64_t timestamp, NativeValue value) {
+  // Same principle as a seqlock. Readers detect an overwritten slot by
+  // checking the write counter after reading.
+  const uint64_t index = count_.load(std::memory_order_relaxed);
+  write_count_.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  Slot& slot = slot_list_[index % capacity_];
+  slot.timestamp.store(timestamp, std::memory_order_relaxed);
+  slot.value.store(std::bit_cast<uint64_t>(value), std::memory_order_relaxed);
+  count_.store(index + 1, std::memory_order_release);
+}
+
+void MetricHistory::Clear() {
+  write_count_ = 0;
+  count_ = 0;
+}
+
+uint64_t MetricHistory::SlotTime(uint64_t index) const {
+  return slot_list_[index % capacity_].timestamp.load(
+      std::memory_order_relaxed);
+}
+
+size_t MetricHistory::Range(uint64_t from, uint64_t to,
+                            std::vector<HistorySample>& dest) const {
+  dest.clear();
+  const uint64_t count = Count();
+  const uint64_t first = count > capacity_ ? count - capacity_ : 0;
+
+  // Binary search for the first sample at or after the from time
+  uint64_t low = first;
+  uint64_t high = count;
+  while (low < high) {
+    const uint64_t middle = low + ((high - low) / 2);
+    if (SlotTime(middle) < from) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  for (uint64_t index = low; index < count; ++index) {
+    const Slot& slot = slot_list_[index % capacity_];
+    HistorySample sample;
+    sample.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+    if (sample.timestamp > to) {
+      break;
+    }
+    sample.value = std::bit_cast<NativeValue>(
+        slot.value.load(std::memory_order_relaxed));
+    dest.push_back(sample);
+  }
+
+  // Remove samples that the producer overwrote while reading
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t write_count = write_count_.load(std::memory_order_relaxed);
+  const uint64_t valid_first =
+      write_count > capacity_ ? write_count - capacity_ : 0;
+  if (valid_first > low) {
+    const auto invalid = std::min<uint64_t>(valid_first - low, dest.size());
+    dest.erase(dest.begin(),
+               dest.begin() + static_cast<std::ptrdiff_t>(invalid));
+  }
+  return dest.size();
+}
+
+}  // namespace metric
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricindex.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "metric/metric.h"
+#include "metric/metricgroup.h"
+#include "metric/stringpool.h"
+
+namespace {
+
+size_t CombineHash(size_t hash1, size_t hash2) {
+  return hash1 ^ (hash2 + 0x9e3779b97f4a7c15ULL + (hash1 << 6) + (hash1 >> 2));
+}
+
+size_t NameHash(std::string_view group_name, std::string_view name) {
+  return CombineHash(std::hash<std::string_view>{}(group_name),
+                     std::hash<std::string_view>{}(name));
+}
+
+size_t IdentityHash(int64_t group_identity, std::string_view name) {
+  return CombineHash(std::hash<int64_t>{}(group_identity),
+                     std::hash<std::string_view>{}(name));
+}
+
+/** Erases the entry that points to the item. The keys are immutable, so
+ * the entry is found by its key. */
+template <typename Map, typename Key, typename Item>
+void EraseItem(Map& map, const Key& key, const Item* item) {
+  auto [first, last] = map.equal_range(key);
+  for (auto itr = first; itr != last; ++itr) {
+    if (itr->second == item) {
+      map.erase(itr);
+      return;
+    }
+  }
+}
+
+template <typename Map, typename Key>
+auto FindFirst(const Map& map, const Key& key) {
+  auto itr = map.find(key);
+  return itr != map.end() ? itr->second : nullptr;
+}
+
+}  // namespace
+
+namespace metric {
+
+GroupIndex::GroupIndex(std::pmr::memory_resource* resource)
+    : name_list_(resource),
+      identity_list_(resource) {
+}
+
+void GroupIndex::Add(MetricGroup& group) {
+  name_list_.emplace(group.Name(), &group);
+  identity_list_.emplace(group.Identity(), &group);
+}
+
+void GroupIndex::Remove(const MetricGroup& group) {
+  EraseItem(name_list_, group.Name(), &group);
+  EraseItem(identity_list_, group.Identity(), &group);
+}
+
+void GroupIndex::Clear() {
+  name_list_.clear();
+  identity_list_.clear();
+}
+
+MetricGroup* GroupIndex::Find(std::string_view name) const {
+  return FindFirst(name_list_, name);
+}
+
+MetricGroup* GroupIndex::Find(int64_t identity) const {
+  return FindFirst(identity_list_, identity);
+}
+
+MetricGroup* GroupIndex::Find(std::string_view name, int64_t identity) const {
+  auto [first, last] = identity_list_.equal_range(identity);
+  for (auto itr = first; itr != last; ++itr) {
+    if (itr->second->Name() == name) {
+      return itr->second;
+    }
+  }
+  return nullptr;
+}
+
+MetricIndex::MetricIndex(std::pmr::memory_resource* resource)
+    : name_list_(resource),
+      identity_list_(resource) {
+}
+
+size_t MetricIndex::KeyHash::operator()(const NameKey& key) const {
+  return NameHash(key.group_name, key.name);
+}
+
+size_t MetricIndex::KeyHash::operator()(const IdentityKey& key) const {
+  return IdentityHash(key.group_identity, key.name);
+}
+
+bool MetricIndex::KeyEqual::operator()(const NameKey& key1,
+                                       const NameKey& key2) const {
+  if (key1.interned && key2.interned) {
+    return StringPool::IsSame(key1.name, key2.name) &&
+           StringPool::IsSame(key1.group_name, key2.group_name);
+  }
+  return key1.name == key2.name && key1.group_name == key2.group_name;
+}
+
+bool MetricIndex::KeyEqual::operator()(const IdentityKey& key1,
+                                       const IdentityKey& key2) const {
+  if (key1.group_identity != key2.group_identity) {
+    return false;
+  }
+  return key1.interned && key2.interned
+             ? StringPool::IsSame(key1.name, key2.name)
+             : key1.name == key2.name;
+}
+
+void MetricIndex::Add(Metric& metric) {
+  name_list_.emplace(NameKey{metric.GroupName(), metric.Name(), true},
+                     &metric);
+  identity_list_.emplace(
+      IdentityKey{metric.GroupIdentity(), metric.Name(), true}, &metric);
+}
+
+void MetricIndex::Remove(const Metric& metric) {
+  EraseItem(name_list_, NameKey{metric.GroupName(), metric.Name(), true},
+            &metric);
+  EraseItem(identity_list_,
+            IdentityKey{metric.GroupIdentity(), metric.Name(), true}, &metric);
+}
+
+void MetricIndex::Clear() {
+  name_list_.clear();
+  identity_list_.clear();
+}
+
+void MetricIndex::Reserve(size_t count) {
+  name_list_.reserve(count);
+  identity_list_.reserve(count);
+}
+
+Metric* MetricIndex::Find(std::string_view group_name,
+                          std::string_view name) const {
+  return FindFirst(name_list_, NameKey{group_name, name});
+}
+
+Metric* MetricIndex::Find(int64_t group_identity,
+                          std::string_view name) const {
+  return FindFirst(identity_list_, IdentityKey{group_identity, name});
+}
+
+Metric* MetricIndex::Find(std::string_view group_name, int64_t group_identity,
+                          std::string_view name) const {
+  auto [first, last] =
+      identity_list_.equal_range(IdentityKey{group_identity, name});
+  for (auto itr = first; itr != last; ++itr) {
+    if (itr->second->GroupName() == group_name) {
+      return itr->second;
+    }
+  }
+  return nullptr;
+}
+
+ShardedMetricIndex::ShardedMetricIndex(std::pmr::memory_resource* resource)
+    : shard_list_(MakeShards(resource, std::make_index_sequence<kShards>())) {
+}
+
+template <size_t... Index>
+std::array<ShardedMetricIndex::Shard, ShardedMetricIndex::kShards>
+ShardedMetricIndex::MakeShards(std::pmr::memory_resource* resource,
+                               std::index_sequence<Index...>) {
+  return {((void)Index, Shard{{}, MetricIndex(resource)})...};
+}
+
+void ShardedMetricIndex::Concurrent(bool concurrent) {
+  for (Shard& shard : shard_list_) {
+    shard.mutex.Enable(concurrent);
+  }
+}
+
+size_t ShardedMetricIndex::ShardIndex(std::string_view name) {
+  return std::hash<std::string_view>{}(name) % kShards;
+}
+
+void ShardedMetricIndex::Add(Metric& metric) {
+  Shard& shard = shard_list_[ShardIndex(metric.Name())];
+  std::scoped_lock lock(shard.mutex);
+  shard.index.Add(metric);
+}
+
+void ShardedMetricIndex::Remove(const Metric& metric) {
+  Shard& shard = shard_list_[ShardIndex(metric.Name())];
+  std::scoped_lock lock(shard.mutex);
+  shard.index.Remove(metric);
+}
+
+void ShardedMetricIndex::Clear() {
+  for (Shard& shard : shard_list_) {
+    std::scoped_lock lock(shard.mutex);
+    shard.index.Clear();
+  }
+}
+
+void ShardedMetricIndex::Reserve(size_t count) {
+  for (Shard& shard : shard_list_) {
+    std::scoped_lock lock(shard.mutex);
+    shard.index.Reserve(count / kShards + 1);
+  }
+}
+
+Metric* ShardedMetricIndex::Find(std::string_view group_name,
+                                 std::string_view name) const {
+  const Shard& shard = shard_list_[ShardIndex(name)];
+  std::shared_lock lock(shard.mutex);
+  return shard.index.Find(group_name, name);
+}
+
+Metric* ShardedMetricIndex::Find(int64_t group_identity,
+                                 std::string_view name) const {
+  const Shard& shard = shard_list_[ShardIndex(name)];
+  std::shared_lock lock(shard.mutex);
+  return shard.index.Find(group_identity, name);
+}
+
+Metric* ShardedMetricIndex::Find(std::string_view group_name,
+                                 int64_t group_identity,
+                                 std::string_view name) const {
+  const Shard& shard = shard_list_[ShardIndex(name)];
+  std::shared_lock lock(shard.mutex);
+  return shard.index.Find(group_name, group_identity, name);
+}
+
+}  // namespace metric
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricorder.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "metric/metric.h"
+#include "metric/stringpool.h"
+
+namespace {
+
+/** Compares two interned names. Equal names are often the same string. */
+int CompareName(std::string_view name1, std::string_view name2) {
+  if (metric::StringPool::IsSame(name1, name2)) {
+    return 0;
+  }
+  return name1.compare(name2);
+}
+
+bool LessAddress(const metric::Metric* metric1,
+                 const metric::Metric* metric2) {
+  return std::less<const metric::Metric*>{}(metric1, metric2);
+}
+
+/** Inserts sorted metrics that are adjacent in the set. Each insert is
+ * hinted by the position after the previous one. */
+template <typename Set>
+void InsertAdjacent(Set& set, std::span<metric::Metric*> metric_list) {
+  std::ranges::sort(metric_list, set.key_comp());
+  auto hint = set.lower_bound(metric_list.front());
+  for (metric::Metric* metric : metric_list) {
+    hint = std::next(set.insert(hint, metric));
+  }
+}
+
+}  // namespace
+
+namespace metric {
+
+MetricOrder::MetricOrder(std::pmr::memory_resource* resource)
+    : name_list_(resource),
+      group_list_(resource),
+      identity_list_(resource) {
+}
+
+bool MetricOrder::GroupLess::operator()(const Metric* metric1,
+                                        const Metric* metric2) const {
+  if (const int result = CompareName(metric1->GroupName(),
+                                     metric2->GroupName());
+      result != 0) {
+    return result < 0;
+  }
+  if (metric1->GroupIdentity() != metric2->GroupIdentity()) {
+    return metric1->GroupIdentity() < metric2->GroupIdentity();
+  }
+  if (const int result = CompareName(metric1->Name(), metric2->Name());
+      result != 0) {
+    return result < 0;
+  }
+  return LessAddress(metric1, metric2);
+}
+
+bool MetricOrder::GroupLess::operator()(const Metric* metric,
+                                        std::string_view group_name) const {
+  return metric->GroupName() < group_name;
+}
+
+bool MetricOrder::GroupLess::operator()(std::string_view group_name,
+                                        const Metric* metric) const {
+  return group_name < metric->GroupName();
+}
+
+bool MetricOrder::IdentityLess::operator()(const Metric* metric1,
+                                           const Metric* metric2) const {
+  if (metric1->GroupIdentity() != metric2->GroupIdentity()) {
+    return metric1->GroupIdentity() < metric2->GroupIdentity();
+  }
+  if (const int result = CompareName(metric1->Name(), metric2->Name());
+      result != 0) {
+    return result < 0;
+  }
+  return LessAddress(metric1, metric2);
+}
+
+bool MetricOrder::IdentityLess::operator()(const Metric* metric,
+                                           int64_t group_identity) const {
+  return metric->GroupIdentity() < group_identity;
+}
+
+bool MetricOrder::IdentityLess::operator()(int64_t group_identity,
+                                           const Metric* metric) const {
+  return group_identity < metric->GroupIdentity();
+}
+
+bool MetricOrder::NameLess::operator()(const Metric* metric1,
+                                       const Metric* metric2) const {
+  if (const int result = CompareName(metric1->Name(), metric2->Name());
+      result != 0) {
+    return result < 0;
+  }
+  return LessAddress(metric1, metric2);
+}
+
+void MetricOrder::Add(Metric& metric) {
+  name_list_.insert(&metric);
+  group_list_.insert(&metric);
+  identity_list_.insert(&metric);
+}
+
+void MetricOrder::Add(std::span<Metric*> metric_list) {
+  if (metric_list.empty()) {
+    return;
+  }
+  // A group's metrics are adjacent in the group orders but not by name
+  InsertAdjacent(group_list_, metric_list);
+  InsertAdjacent(identity_list_, metric_list);
+  for (Metric* metric : metric_list) {
+    name_list_.insert(metric);
+  }
+}
+
+void MetricOrder::Remove(Metric& metric) {
+  name_list_.erase(&metric);
+  group_list_.erase(&metric);
+  identity_list_.erase(&metric);
+}
+
+void MetricOrder::Clear() {
+  name_list_.clear();
+  group_list_.clear();
+  identity_list_.clear();
+}
+
+MetricOrder::Range<MetricOrder::GroupLess> MetricOrder::ByGroupName(
+    std::string_view group_name) const {
+  auto [first, last] = group_list_.equal_range(group_name);
+  return {first, last};
+}
+
+MetricOrder::Range<MetricOrder::IdentityLess> MetricOrder::ByGroupIdentity(
+    int64_t group_identity) const {
+  auto [first, last] = identity_list_.equal_range(group_identity);
+  return {first, last};
+}
+
+}  // namespace metric
@@ -2,6 +2,8 @@
 // Created by ihedv on 2024-09-22.
 //
 
+#include <algorithm>
+#include <memory>
 #include <utility>
 
 #include "metric/metricproperty.h"
@@ -9,131 +11,229 @@
 
 namespace metric {
 
-MetricProperty::MetricProperty(const MetricProperty &property)
-: key_(property.key_),
-  type_(property.type_),
-  is_null_(property.is_null_ ),
-  value_(property.value_) {
-
-}
-MetricProperty &MetricProperty::operator=(const MetricProperty &property) {
-  if (&property == this) {
-    return *this;
-  }
-  key_ = property.key_;
-  type_ = property.type_;
-  is_null_ = property.is_null_;
-  value_ = property.value_;
-  return *this;
-}
 void MetricProperty::Null(bool is_null) {
-  std::scoped_lock lock(property_mutex_);
   is_null_ = is_null;
 }
 
 bool MetricProperty::IsNull() const {
-  std::scoped_lock lock(property_mutex_);
   return is_null_;
 }
 
-MetricProperty::MetricProperty(std::string key, std::string value)
-: key_(std::move(key)),
+MetricProperty::MetricProperty() : value_() {
+}
+
+MetricProperty::MetricProperty(std::string_view key, std::string value)
+: key_(StringPool::Global().Intern(key)),
   type_(MetricType::String),
   is_null_(false),
   value_(std::move(value)) {
 
 }
 
-std::vector<MetricPropertyList> &MetricProperty::PropertyArray() {
-  return prop_array_;
+MetricProperty::MetricProperty(const MetricProperty& property)
+    : key_(property.key_),
+      type_(property.type_),
+      is_null_(property.is_null_),
+      prop_array_(property.CopyArray()) {
+  StringPool::Retain(key_);
+  if (property.is_native_) {
+    StoreNative(property.native_);
+  } else {
+    value_ = property.value_;
+  }
 }
 
-const std::vector<MetricPropertyList> &MetricProperty::PropertyArray() const {
-  return prop_array_;
+MetricProperty::MetricProperty(MetricProperty&& property) noexcept
+    : key_(std::exchange(property.key_, {})),
+      type_(property.type_),
+      is_null_(property.is_null_),
+      prop_array_(std::move(property.prop_array_)) {
+  if (property.is_native_) {
+    StoreNative(property.native_);
+  } else {
+    value_ = std::move(property.value_);
+  }
 }
 
-template<>
-bool MetricProperty::Value() const {
-  std::scoped_lock lock(property_mutex_);
-  if (value_.empty()) {
-    return false;
+MetricProperty& MetricProperty::operator=(const MetricProperty& property) {
+  if (this != &property) {
+    StringPool::Retain(property.key_);
+    StringPool::Global().Release(key_);
+    key_ = property.key_;
+    type_ = property.type_;
+    is_null_ = property.is_null_;
+    if (property.is_native_) {
+      StoreNative(property.native_);
+    } else {
+      TextValue() = property.value_;
+    }
+    prop_array_ = property.CopyArray();
   }
-  switch (value_[0]) {
-    case 'Y':
-    case 'y':
-    case 'T':
-    case 't':
-    case '1':
-      return true;
-
-    default:
-      break;
+  return *this;
+}
+
+MetricProperty& MetricProperty::operator=(MetricProperty&& property) noexcept {
+  if (this != &property) {
+    StringPool::Global().Release(key_);
+    key_ = std::exchange(property.key_, {});
+    type_ = property.type_;
+    is_null_ = property.is_null_;
+    if (property.is_native_) {
+      StoreNative(property.native_);
+    } else {
+      TextValue() = std::move(property.value_);
+    }
+    prop_array_ = std::move(property.prop_array_);
   }
-  return false;
+  return *this;
 }
 
-template<>
-uint8_t MetricProperty::Value() const {
-  std::scoped_lock lock(property_mutex_);
-  uint8_t temp = 0;
-  try {
-    temp = static_cast< uint8_t>(std::stoul(value_));
-  } catch (const std::exception&) {}
-  return temp;
+MetricProperty::~MetricProperty() {
+  if (!is_native_) {
+    std::destroy_at(&value_);
+  }
+  StringPool::Global().Release(key_);
 }
 
-template<>
-int8_t MetricProperty::Value() const {
-  std::scoped_lock lock(property_mutex_);
-  int8_t temp = 0;
-  try {
-    temp = static_cast< int8_t>(std::stoi(value_));
-  } catch (const std::exception&) {
+void MetricProperty::Key(std::string_view key) {
+  const std::string_view old_key = key_;
+  key_ = StringPool::Global().Intern(key);
+  StringPool::Global().Release(old_key);
+}
+
+size_t MetricPropertyList::LowerBound(std::string_view key) const {
+  const auto itr = std::ranges::lower_bound(
+      list_, key, std::less<>{},
+      [](const MetricProperty& property) { return property.Key(); });
+  return static_cast<size_t>(itr - list_.cbegin());
+}
+
+MetricProperty* MetricPropertyList::Find(std::string_view key) {
+  const size_t index = LowerBound(key);
+  return index < list_.size() && list_[index].Key() == key
+             ? &list_[index]
+             : nullptr;
+}
 
+const MetricProperty* MetricPropertyList::Find(std::string_view key) const {
+  const size_t index = LowerBound(key);
+  return index < list_.size() && list_[index].Key() == key
+             ? &list_[index]
+             : nullptr;
+}
+
+MetricProperty& MetricPropertyList::Insert(MetricProperty property) {
+  const size_t index = LowerBound(property.Key());
+  if (index < list_.size() &&
+      StringPool::IsSame(list_[index].Key(), property.Key())) {
+    list_[index] = std::move(property);
+    return list_[index];
   }
-  return temp;
+  return *list_.insert(list_.begin() + static_cast<std::ptrdiff_t>(index),
+                       std::move(property));
 }
 
-template<>
-std::string MetricProperty::Value() const {
-  std::scoped_lock lock(property_mutex_);
+bool MetricPropertyList::Erase(std::string_view key) {
+  const size_t index = LowerBound(key);
+  if (index >= list_.size() || list_[index].Key() != key) {
+    return false;
+  }
+  list_.erase(list_.begin() + static_cast<std::ptrdiff_t>(index));
+  return true;
+}
+
+void MetricPropertyList::Reserve(size_t count) {
+  list_.reserve(count);
+}
+
+void MetricProperty::DataType(MetricType type) {
+  if (is_native_ && type != type_) {
+    // The number is kept as the text it would have been stored as
+    NumberBuffer buffer;
+    TextValue() = NativeToChars(type_, native_, buffer);
+  }
+  type_ = type;
+}
+
+std::vector<MetricPropertyList>& MetricProperty::PropertyArray() {
+  if (!prop_array_) {
+    prop_array_ = std::make_unique<std::vector<MetricPropertyList>>();
+  }
+  return *prop_array_;
+}
+
+const std::vector<MetricPropertyList>& MetricProperty::PropertyArray() const {
+  static const std::vector<MetricPropertyList> kEmptyArray;
+  return prop_array_ ? *prop_array_ : kEmptyArray;
+}
+
+std::unique_ptr<std::vector<MetricPropertyList>> MetricProperty::CopyArray()
+    const {
+  return prop_array_
+             ? std::make_unique<std::vector<MetricPropertyList>>(*prop_array_)
+             : nullptr;
+}
+
+std::string& MetricProperty::TextValue() {
+  if (is_native_) {
+    std::construct_at(&value_);
+    is_native_ = false;
+  }
   return value_;
 }
 
-template<>
-void MetricProperty::Value(std::string value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = std::move(value);
+void MetricProperty::StoreNative(NativeValue value) {
+  if (!is_native_) {
+    std::destroy_at(&value_);
+    std::construct_at(&native_, value);
+    is_native_ = true;
+  } else {
+    native_ = value;
+  }
 }
 
-template<>
-void MetricProperty::Value(std::string_view value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = value;
+void MetricProperty::StoreValue(MetricType type, NativeValue value) {
+  if (type == type_) {
+    StoreNative(value);
+    return;
+  }
+  NumberBuffer buffer;
+  TextValue() = NativeToChars(type, value, buffer);
+}
+
+NativeValue MetricProperty::LoadValue(MetricType type) const {
+  if (is_native_) {
+    return ConvertNative(type_, type, native_);
+  }
+  NativeValue value;
+  if (!StringToNative(type, value_, value)) {
+    value = NativeValue();
+  }
+  return value;
 }
 
 template<>
-void MetricProperty::Value(const char* value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = value != nullptr ? value : "";
+std::string MetricProperty::Value() const {
+  if (is_native_) {
+    NumberBuffer buffer;
+    return std::string(NativeToChars(type_, native_, buffer));
+  }
+  return value_;
 }
 
 template<>
-void MetricProperty::Value(bool value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = value ? "1" : "0";
+void MetricProperty::Value(std::string value) {
+  TextValue() = std::move(value);
 }
 
 template<>
-void MetricProperty::Value(float value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = FloatToString(value);
+void MetricProperty::Value(std::string_view value) {
+  TextValue() = value;
 }
 
 template<>
-void MetricProperty::Value(double value) {
-  std::scoped_lock lock(property_mutex_);
-  value_ = DoubleToString(value);
+void MetricProperty::Value(const char* value) {
+  TextValue() = value != nullptr ? value : "";
 }
 
 } // pub_sub
\ No newline at end of file
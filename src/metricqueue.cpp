@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricqueue.h"
+
+#include <algorithm>
+
+#include "metric/metric.h"
+
+namespace metric {
+
+void MetricQueue::Push(Metric& metric) {
+  if (metric.queued_.exchange(true, std::memory_order_acq_rel)) {
+    return; // Already in the queue
+  }
+  Metric* head = head_.load(std::memory_order_relaxed);
+  do {
+    metric.next_queued_ = head;
+  } while (!head_.compare_exchange_weak(head, &metric,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+void MetricQueue::TakeAllLocked() {
+  const size_t first = pending_list_.size();
+  for (Metric* metric = head_.exchange(nullptr, std::memory_order_acquire);
+       metric != nullptr;) {
+    Metric* next = metric->next_queued_;
+    metric->next_queued_ = nullptr;
+    if (metric->Queue() != this) {
+      // Detached, typical deleted. The owner may free the metric when it
+      // isn't queued, so this is the last access.
+      metric->queued_.store(false, std::memory_order_release);
+    } else {
+      pending_list_.push_back(metric);
+    }
+    metric = next;
+  }
+  // The list is last in first out
+  std::reverse(pending_list_.begin() + static_cast<std::ptrdiff_t>(first),
+               pending_list_.end());
+}
+
+size_t MetricQueue::Drain(std::vector<Metric*>& dest) {
+  dest.clear();
+  std::scoped_lock lock(consumer_mutex_);
+  TakeAllLocked();
+  for (Metric* metric : pending_list_) {
+    // A metric may have been detached after it was taken
+    if (metric->Queue() == this) {
+      metric->ResetUpdated();
+      dest.push_back(metric);
+    }
+    // From now on, a new update pushes the metric again
+    metric->queued_.store(false, std::memory_order_release);
+  }
+  pending_list_.clear();
+  return dest.size();
+}
+
+void MetricQueue::Purge() {
+  std::scoped_lock lock(consumer_mutex_);
+  TakeAllLocked();
+  std::erase_if(pending_list_, [this](Metric* metric) {
+    if (metric->Queue() == this) {
+      return false;
+    }
+    metric->queued_.store(false, std::memory_order_release);
+    return true;
+  });
+}
+
+bool MetricQueue::IsEmpty() const {
+  if (head_.load(std::memory_order_acquire) != nullptr) {
+    return false;
+  }
+  std::scoped_lock lock(consumer_mutex_);
+  return pending_list_.empty();
+}
+
+}  // namespace metric
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricsnapshot.h"
+
+namespace metric {
+
+bool MetricChangeSet::Reserve(uint32_t row) {
+  const size_t chunk_index = row / kChunkSize;
+  if (chunk_index >= kMaxChunks) {
+    return false;
+  }
+  for (size_t index = nof_chunks_.load(std::memory_order_relaxed);
+       index <= chunk_index; ++index) {
+    chunk_list_[index] = std::make_unique<Chunk>();
+    nof_chunks_.store(index + 1, std::memory_order_release);
+  }
+  return true;
+}
+
+std::string SnapshotValue::Text() const {
+  if (text) {
+    return *text;
+  }
+  return IsScalar(type) ? NativeToString(type, value) : std::string();
+}
+
+const SnapshotValue* MetricSnapshot::Get(MetricHandle handle) const {
+  if (!handle.IsValid()) {
+    return nullptr;
+  }
+  const Page* page = PageOf(handle.Index() / kPageSize);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  const SnapshotValue& item = (*page)[handle.Index() % kPageSize];
+  return item.handle == handle ? &item : nullptr;
+}
+
+bool MetricSnapshot::IsShared(const MetricSnapshot& snapshot,
+                              uint32_t row) const {
+  const size_t page_index = row / kPageSize;
+  return page_index < nof_pages_ && page_index < snapshot.nof_pages_ &&
+         PageOf(page_index) == snapshot.PageOf(page_index);
+}
+
+bool MetricSnapshot::IsSameValue(const SnapshotValue& item1,
+                                 const SnapshotValue& item2) {
+  if (item1.handle != item2.handle || item1.type != item2.type ||
+      item1.timestamp != item2.timestamp || item1.valid != item2.valid) {
+    return false;
+  }
+  if (IsScalar(item1.type)) {
+    return IsSameNative(item1.type, item1.value, item2.value);
+  }
+  if (item1.text == item2.text) {
+    return true;
+  }
+  return item1.text && item2.text && *item1.text == *item2.text;
+}
+
+}  // namespace metric
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/metricvalue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+#include "metrichelper.h"
+
+namespace {
+
+int64_t NarrowSigned(metric::MetricType type, int64_t value) {
+  switch (type) {
+    case metric::MetricType::Int8:
+      return static_cast<int8_t>(value);
+
+    case metric::MetricType::Int16:
+      return static_cast<int16_t>(value);
+
+    case metric::MetricType::Int32:
+      return static_cast<int32_t>(value);
+
+    default:
+      break;
+  }
+  return value;
+}
+
+uint64_t NarrowUnsigned(metric::MetricType type, uint64_t value) {
+  switch (type) {
+    case metric::MetricType::UInt8:
+      return static_cast<uint8_t>(value);
+
+    case metric::MetricType::UInt16:
+      return static_cast<uint16_t>(value);
+
+    case metric::MetricType::UInt32:
+      return static_cast<uint32_t>(value);
+
+    default:
+      break;
+  }
+  return value;
+}
+
+/** Converts a floating point value to an integer type. The value is
+ * truncated and clamped to the range of the type, and NaN becomes 0. A
+ * plain cast of these values is undefined. */
+template <typename T>
+T FromFloating(double value) {
+  if (std::isnan(value)) {
+    return 0;
+  }
+  constexpr double kMin = static_cast<double>(std::numeric_limits<T>::min());
+  // The max of a 64-bit type isn't exact as a double but max + 1 is
+  constexpr double kLimit =
+      static_cast<double>(std::numeric_limits<T>::max() / 2 + 1) * 2.0;
+  if (value <= kMin) {
+    return std::numeric_limits<T>::min();
+  }
+  if (value >= kLimit) {
+    return std::numeric_limits<T>::max();
+  }
+  return static_cast<T>(value);
+}
+
+int64_t FloatingToSigned(metric::MetricType type, double value) {
+  switch (type) {
+    case metric::MetricType::Int8:
+      return FromFloating<int8_t>(value);
+
+    case metric::MetricType::Int16:
+      return FromFloating<int16_t>(value);
+
+    case metric::MetricType::Int32:
+      return FromFloating<int32_t>(value);
+
+    default:
+      break;
+  }
+  return FromFloating<int64_t>(value);
+}
+
+uint64_t FloatingToUnsigned(metric::MetricType type, double value) {
+  switch (type) {
+    case metric::MetricType::UInt8:
+      return FromFloating<uint8_t>(value);
+
+    case metric::MetricType::UInt16:
+      return FromFloating<uint16_t>(value);
+
+    case metric::MetricType::UInt32:
+      return FromFloating<uint32_t>(value);
+
+    default:
+      break;
+  }
+  return FromFloating<uint64_t>(value);
+}
+
+}  // namespace
+
+namespace metric {
+
+bool IsSameNative(MetricType type, NativeValue value1, NativeValue value2) {
+  switch (KindOf(type)) {
+    case ValueKind::Signed:
+      return value1.signed_value == value2.signed_value;
+
+    case ValueKind::Unsigned:
+      return value1.unsigned_value == value2.unsigned_value;
+
+    case ValueKind::Float:
+      return std::bit_cast<uint32_t>(value1.float_value) ==
+             std::bit_cast<uint32_t>(value2.float_value);
+
+    case ValueKind::Double:
+      return std::bit_cast<uint64_t>(value1.double_value) ==
+             std::bit_cast<uint64_t>(value2.double_value);
+
+    case ValueKind::Boolean:
+      return value1.bool_value == value2.bool_value;
+
+    default:
+      break;
+  }
+  return true;
+}
+
+NativeValue ConvertNative(MetricType from_type, MetricType to_type,
+                          NativeValue value) {
+  const ValueKind from_kind = KindOf(from_type);
+  const ValueKind to_kind = KindOf(to_type);
+  if (from_type == to_type) {
+    return value;
+  }
+  NativeValue dest;
+  switch (to_kind) {
+    case ValueKind::Signed: {
+      int64_t temp = 0;
+      switch (from_kind) {
+        case ValueKind::Signed: temp = value.signed_value; break;
+        case ValueKind::Unsigned:
+          temp = static_cast<int64_t>(value.unsigned_value);
+          break;
+        case ValueKind::Float:
+          temp = FloatingToSigned(to_type, value.float_value);
+          break;
+        case ValueKind::Double:
+          temp = FloatingToSigned(to_type, value.double_value);
+          break;
+        case ValueKind::Boolean: temp = value.bool_value ? 1 : 0; break;
+        default: break;
+      }
+      dest.signed_value = NarrowSigned(to_type, temp);
+      break;
+    }
+
+    case ValueKind::Unsigned: {
+      uint64_t temp = 0;
+      switch (from_kind) {
+        case ValueKind::Signed:
+          temp = static_cast<uint64_t>(value.signed_value);
+          break;
+        case ValueKind::Unsigned: temp = value.unsigned_value; break;
+        case ValueKind::Float:
+          temp = FloatingToUnsigned(to_type, value.float_value);
+          break;
+        case ValueKind::Double:
+          temp = FloatingToUnsigned(to_type, value.double_value);
+          break;
+        case ValueKind::Boolean: temp = value.bool_value ? 1 : 0; break;
+        default: break;
+      }
+      dest.unsigned_value = NarrowUnsigned(to_type, temp);
+      break;
+    }
+
+    case ValueKind::Float:
+      switch (from_kind) {
+        case ValueKind::Signed:
+          dest.float_value = static_cast<float>(value.signed_value);
+          break;
+        case ValueKind::Unsigned:
+          dest.float_value = static_cast<float>(value.unsigned_value);
+          break;
+        case ValueKind::Float: dest.float_value = value.float_value; break;
+        case ValueKind::Double:
+          dest.float_value = static_cast<float>(value.double_value);
+          break;
+        case ValueKind::Boolean:
+          dest.float_value = value.bool_value ? 1.0F : 0.0F;
+          break;
+        default: break;
+      }
+      break;
+
+    case ValueKind::Double:
+      switch (from_kind) {
+        case ValueKind::Signed:
+          dest.double_value = static_cast<double>(value.signed_value);
+          break;
+        case ValueKind::Unsigned:
+          dest.double_value = static_cast<double>(value.unsigned_value);
+          break;
+        case ValueKind::Float: dest.double_value = value.float_value; break;
+        case ValueKind::Double: dest.double_value = value.double_value; break;
+        case ValueKind::Boolean:
+          dest.double_value = value.bool_value ? 1.0 : 0.0;
+          break;
+        default: break;
+      }
+      break;
+
+    case ValueKind::Boolean:
+      switch (from_kind) {
+        case ValueKind::Signed:
+          dest.bool_value = value.signed_value != 0;
+          break;
+        case ValueKind::Unsigned:
+          dest.bool_value = value.unsigned_value != 0;
+          break;
+        case ValueKind::Float: dest.bool_value = value.float_value != 0; break;
+        case ValueKind::Double:
+          dest.bool_value = value.double_value != 0;
+          break;
+        case ValueKind::Boolean: dest.bool_value = value.bool_value; break;
+        default: break;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return dest;
+}
+
+std::string NativeToString(MetricType type, NativeValue value) {
+  NumberBuffer buffer;
+  return std::string(NativeToChars(type, value, buffer));
+}
+
+bool StringToNative(MetricType type, std::string_view text,
+                    NativeValue& value) {
+  NativeValue temp;
+  switch (KindOf(type)) {
+    case ValueKind::Signed: {
+      int64_t number = 0;
+      if (!CharsToNumber(text, number)) {
+        return false;
+      }
+      temp.signed_value = NarrowSigned(type, number);
+      break;
+    }
+
+    case ValueKind::Unsigned: {
+      uint64_t number = 0;
+      if (!CharsToNumber(text, number)) {
+        return false;
+      }
+      temp.unsigned_value = NarrowUnsigned(type, number);
+      break;
+    }
+
+    case ValueKind::Float:
+      if (!CharsToNumber(text, temp.float_value)) {
+        return false;
+      }
+      break;
+
+    case ValueKind::Double:
+      if (!CharsToNumber(text, temp.double_value)) {
+        return false;
+      }
+      break;
+
+    case ValueKind::Boolean: {
+      const auto first = std::ranges::find_if_not(text, [](char in) -> bool {
+        return std::isspace(static_cast<unsigned char>(in)) != 0;
+      });
+      temp.bool_value = first != text.end() &&
+          (*first == 'Y' || *first == 'y' || *first == 'T' ||
+           *first == 't' || *first == '1');
+      break;
+    }
+
+    default:
+      return false;
+  }
+  value = temp;
+  return true;
+}
+
+}  // namespace metric
@@ -0,0 +1,623 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/sqlitedatabase.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sqlite3.h>
+
+namespace {
+
+constexpr const char* kCreateTables =
+    "CREATE TABLE IF NOT EXISTS metric_group ("
+    " group_id INTEGER PRIMARY KEY,"
+    " name TEXT NOT NULL,"
+    " identity INTEGER NOT NULL,"
+    " type INTEGER NOT NULL DEFAULT 0,"
+    " description TEXT,"
+    " UNIQUE (name, identity));"
+    "CREATE TABLE IF NOT EXISTS metric ("
+    " metric_id INTEGER PRIMARY KEY,"
+    " group_name TEXT NOT NULL,"
+    " group_identity INTEGER NOT NULL,"
+    " name TEXT NOT NULL,"
+    " data_type INTEGER NOT NULL DEFAULT 0,"
+    " value,"
+    " timestamp INTEGER NOT NULL DEFAULT 0,"
+    " valid INTEGER NOT NULL DEFAULT 0,"
+    " UNIQUE (group_name, group_identity, name));"
+    "CREATE TABLE IF NOT EXISTS metric_property ("
+    " metric_id INTEGER NOT NULL,"
+    " key TEXT NOT NULL,"
+    " data_type INTEGER NOT NULL DEFAULT 0,"
+    " is_null INTEGER NOT NULL DEFAULT 0,"
+    " value TEXT,"
+    " PRIMARY KEY (metric_id, key)) WITHOUT ROWID;";
+
+constexpr const char* kInsertGroup =
+    "INSERT INTO metric_group (name, identity, type, description) "
+    "VALUES (?, ?, ?, ?)";
+
+constexpr const char* kInsertMetric =
+    "INSERT INTO metric (metric_id, group_name, group_identity, name,"
+    " data_type, value, timestamp, valid) VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+
+constexpr const char* kInsertProperty =
+    "INSERT INTO metric_property (metric_id, key, data_type, is_null, value) "
+    "VALUES (?, ?, ?, ?, ?)";
+
+constexpr const char* kUpsertValue =
+    "INSERT INTO metric (group_name, group_identity, name, data_type, value,"
+    " timestamp, valid) VALUES (?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT (group_name, group_identity, name) DO UPDATE SET"
+    " data_type = excluded.data_type, value = excluded.value,"
+    " timestamp = excluded.timestamp, valid = excluded.valid";
+
+constexpr const char* kSelectGroup =
+    "SELECT name, identity, type, description FROM metric_group";
+
+constexpr const char* kSelectMetric =
+    "SELECT metric_id, group_name, group_identity, name, data_type, value,"
+    " timestamp, valid FROM metric "
+    "ORDER BY group_identity, group_name, metric_id";
+
+constexpr const char* kSelectProperty =
+    "SELECT metric_id, key, data_type, is_null, value FROM metric_property "
+    "ORDER BY metric_id";
+
+/** Prepares a statement that is kept by the connection, or nullptr. */
+sqlite3_stmt* PrepareCached(sqlite3* db, const char* sql) {
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt,
+                         nullptr) != SQLITE_OK) {
+    sqlite3_finalize(stmt);
+    return nullptr;
+  }
+  return stmt;
+}
+
+/** Prepared statement that is finalized when destroyed, unless it's a
+ * cached statement. */
+class Statement {
+ public:
+  Statement(sqlite3* db, const char* sql) : owner_(true) {
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt_, nullptr) != SQLITE_OK) {
+      sqlite3_finalize(stmt_);
+      stmt_ = nullptr;
+    }
+  }
+  /** Uses a cached statement without taking the ownership. */
+  explicit Statement(sqlite3_stmt* stmt) : stmt_(stmt) {}
+  ~Statement() {
+    if (owner_) {
+      sqlite3_finalize(stmt_);
+    }
+  }
+  Statement(const Statement&) = delete;
+  Statement& operator=(const Statement&) = delete;
+
+  [[nodiscard]] bool IsOk() const { return stmt_ != nullptr; }
+
+  void Bind(int index, int64_t value) {
+    sqlite3_bind_int64(stmt_, index, value);
+  }
+  void Bind(int index, double value) {
+    sqlite3_bind_double(stmt_, index, value);
+  }
+  /** The text isn't copied, so it must be valid until the step. */
+  void Bind(int index, std::string_view text) {
+    sqlite3_bind_text(stmt_, index, text.data(), static_cast<int>(text.size()),
+                      SQLITE_STATIC);
+  }
+  void BindCopy(int index, const std::string& text) {
+    sqlite3_bind_text(stmt_, index, text.data(), static_cast<int>(text.size()),
+                      SQLITE_TRANSIENT);
+  }
+  void BindNull(int index) { sqlite3_bind_null(stmt_, index); }
+
+  /** Returns true while there is a row to read. */
+  bool Step() {
+    result_ = sqlite3_step(stmt_);
+    return result_ == SQLITE_ROW;
+  }
+
+  /** Returns true if the last Step() read all rows without an error. */
+  [[nodiscard]] bool IsDone() const { return result_ == SQLITE_DONE; }
+
+  /** Executes an insert or update and resets the statement for reuse. */
+  bool Execute() {
+    const bool done = sqlite3_step(stmt_) == SQLITE_DONE;
+    sqlite3_reset(stmt_);
+    sqlite3_clear_bindings(stmt_);
+    return done;
+  }
+
+  [[nodiscard]] int Type(int column) const {
+    return sqlite3_column_type(stmt_, column);
+  }
+  [[nodiscard]] int64_t Int(int column) const {
+    return sqlite3_column_int64(stmt_, column);
+  }
+  [[nodiscard]] double Real(int column) const {
+    return sqlite3_column_double(stmt_, column);
+  }
+  [[nodiscard]] std::string_view Text(int column) const {
+    const auto* text = sqlite3_column_text(stmt_, column);
+    return text != nullptr
+               ? std::string_view(reinterpret_cast<const char*>(text),
+                                  sqlite3_column_bytes(stmt_, column))
+               : std::string_view();
+  }
+
+ private:
+  sqlite3_stmt* stmt_ = nullptr;
+  bool owner_ = false;
+  int result_ = SQLITE_OK;
+};
+
+/** Binds the value of a snapshot. A text is bound without a copy, so the
+ * snapshot must be kept until the statement has been executed. */
+void BindValue(Statement& stmt, int index, const metric::SnapshotValue& item) {
+  using metric::ValueKind;
+  const metric::NativeValue value = item.value;
+  switch (metric::KindOf(item.type)) {
+    case ValueKind::Signed:
+      stmt.Bind(index, value.signed_value);
+      break;
+    case ValueKind::Unsigned:
+      stmt.Bind(index, static_cast<int64_t>(value.unsigned_value));
+      break;
+    case ValueKind::Boolean:
+      stmt.Bind(index, static_cast<int64_t>(value.bool_value ? 1 : 0));
+      break;
+    case ValueKind::Float:
+      stmt.Bind(index, static_cast<double>(value.float_value));
+      break;
+    case ValueKind::Double:
+      stmt.Bind(index, value.double_value);
+      break;
+    default:
+      // A null data pointer would bind SQL NULL instead of an empty text
+      stmt.Bind(index, item.text ? std::string_view(*item.text)
+                                 : std::string_view(""));
+      break;
+  }
+}
+
+/** Group row, kept until the file has been read. */
+struct StoredGroup {
+  std::string name;
+  int32_t identity = 0;
+  int64_t type = 0;
+  std::string description;
+};
+
+/** Property row, kept until the metrics have been created. */
+struct StoredProperty {
+  int64_t metric_id = 0;
+  metric::MetricProperty property;
+};
+
+/** Value of a metric row, kept until the metric has been created. */
+struct StoredValue {
+  int64_t metric_id = 0;
+  int column_type = SQLITE_NULL;
+  int64_t int_value = 0;
+  double real_value = 0.0;
+  std::string text;
+  uint64_t timestamp = 0;
+  bool valid = false;
+};
+
+void RestoreValue(metric::Metric& metric, const StoredValue& stored) {
+  using metric::MetricType;
+  const MetricType type = metric.DataType();
+  switch (stored.column_type) {
+    case SQLITE_INTEGER:
+    case SQLITE_FLOAT: {
+      if (!metric::IsScalar(type)) {
+        break;
+      }
+      // The column type tells how the value was stored, which isn't the
+      // metric type if the type changed after the save.
+      metric::NativeValue value;
+      MetricType column_type = MetricType::Int64;
+      if (stored.column_type == SQLITE_FLOAT) {
+        value.double_value = stored.real_value;
+        column_type = MetricType::Double;
+      } else {
+        value.signed_value = stored.int_value;
+      }
+      metric.Update(stored.timestamp, type,
+                    metric::ConvertNative(column_type, type, value));
+      break;
+    }
+
+    case SQLITE_TEXT:
+      metric.Timestamp(stored.timestamp);
+      metric.Value(stored.text);
+      break;
+
+    default:
+      break;
+  }
+  metric.Valid(stored.valid);
+}
+
+}  // namespace
+
+namespace metric {
+
+SqliteDatabase::SqliteDatabase() {
+  type_ = TypeOfDatabase::Sqlite;
+}
+
+SqliteDatabase::~SqliteDatabase() {
+  Close();
+}
+
+void SqliteDatabase::Enable(bool enable) {
+  if (enable == IsEnabled()) {
+    return;
+  }
+  if (enable) {
+    const bool operable = Open() && Load();
+    enabled_ = true;
+    operable_ = operable;
+    if (operable && IsConcurrent()) {
+      StartFlush();
+    }
+  } else {
+    Close();
+    enabled_ = false;
+    operable_ = false;
+  }
+}
+
+bool SqliteDatabase::Open() {
+  std::scoped_lock lock(db_mutex_);
+  if (db_ != nullptr) {
+    return true;
+  }
+  if (sqlite3_open_v2(Filename().c_str(), &db_,
+                      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                          SQLITE_OPEN_NOMUTEX,
+                      nullptr) != SQLITE_OK) {
+    sqlite3_close(db_);
+    db_ = nullptr;
+    return false;
+  }
+  // The WAL journal lets other processes read while values are flushed
+  Execute("PRAGMA journal_mode = WAL");
+  Execute("PRAGMA synchronous = NORMAL");
+  if (!Execute(kCreateTables)) {
+    sqlite3_close(db_);
+    db_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void SqliteDatabase::Close() {
+  // The flush thread uses the connection and the flushed snapshot
+  StopFlush();
+  std::scoped_lock lock(db_mutex_);
+  sqlite3_finalize(upsert_value_);
+  upsert_value_ = nullptr;
+  if (db_ != nullptr) {
+    sqlite3_close(db_);
+    db_ = nullptr;
+  }
+  flushed_.reset();
+}
+
+bool SqliteDatabase::IsOpen() const {
+  std::scoped_lock lock(db_mutex_);
+  return db_ != nullptr;
+}
+
+bool SqliteDatabase::Execute(const char* sql) {
+  return db_ != nullptr &&
+         sqlite3_exec(db_, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool SqliteDatabase::Load() {
+  // The rows are read under the connection lock, and the groups and
+  // metrics are created after it has been released
+  std::vector<StoredGroup> group_list;
+  std::vector<MetricDefinition> definition_list;
+  std::vector<StoredValue> value_list;
+  std::vector<StoredProperty> property_list;
+  {
+    std::scoped_lock lock(db_mutex_);
+    if (db_ == nullptr) {
+      return false;
+    }
+    Statement select_group(db_, kSelectGroup);
+    Statement select_metric(db_, kSelectMetric);
+    Statement select_property(db_, kSelectProperty);
+    if (!select_group.IsOk() || !select_metric.IsOk() ||
+        !select_property.IsOk()) {
+      return false;
+    }
+
+    while (select_group.Step()) {
+      StoredGroup& group = group_list.emplace_back();
+      group.name = select_group.Text(0);
+      group.identity = static_cast<int32_t>(select_group.Int(1));
+      group.type = select_group.Int(2);
+      group.description = select_group.Text(3);
+    }
+    if (!select_group.IsDone()) {
+      return false;
+    }
+
+    // The rows are sorted by group, so the import keeps their order
+    while (select_metric.Step()) {
+      MetricDefinition& definition = definition_list.emplace_back();
+      definition.group_name = select_metric.Text(1);
+      definition.group_identity = static_cast<int32_t>(select_metric.Int(2));
+      definition.name = select_metric.Text(3);
+      definition.data_type = static_cast<MetricType>(select_metric.Int(4));
+
+      StoredValue& stored = value_list.emplace_back();
+      stored.metric_id = select_metric.Int(0);
+      stored.column_type = select_metric.Type(5);
+      if (stored.column_type == SQLITE_INTEGER) {
+        stored.int_value = select_metric.Int(5);
+      } else if (stored.column_type == SQLITE_FLOAT) {
+        stored.real_value = select_metric.Real(5);
+      } else if (stored.column_type == SQLITE_TEXT) {
+        stored.text = select_metric.Text(5);
+      }
+      stored.timestamp = static_cast<uint64_t>(select_metric.Int(6));
+      stored.valid = select_metric.Int(7) != 0;
+    }
+    if (!select_metric.IsDone()) {
+      return false;
+    }
+
+    while (select_property.Step()) {
+      StoredProperty& stored = property_list.emplace_back(
+          select_property.Int(0),
+          MetricProperty(select_property.Text(1),
+                         std::string(select_property.Text(4))));
+      stored.property.DataType(
+          static_cast<MetricType>(select_property.Int(2)));
+      stored.property.Null(select_property.Int(3) != 0);
+    }
+    if (!select_property.IsDone()) {
+      return false;
+    }
+  }
+
+  for (const StoredGroup& stored : group_list) {
+    auto* group = CreateGroup(stored.name, stored.identity);
+    group->Type(static_cast<TypeOfGroup>(stored.type));
+    group->Description(stored.description);
+  }
+
+  ImportMetrics(definition_list);
+
+  std::unordered_map<int64_t, Metric*> id_list;
+  id_list.reserve(definition_list.size());
+  for (size_t index = 0; index < definition_list.size(); ++index) {
+    const MetricDefinition& definition = definition_list[index];
+    Metric* metric = metric_index_.Find(definition.group_name,
+                                        definition.group_identity,
+                                        definition.name);
+    if (metric == nullptr) {
+      continue;
+    }
+    RestoreValue(*metric, value_list[index]);
+    id_list.emplace(value_list[index].metric_id, metric);
+  }
+
+  // The properties are sorted by metric, so each list is published once
+  Metric* metric = nullptr;
+  int64_t metric_id = 0;
+  MetricPropertyList metric_properties;
+  const auto publish = [&] {
+    if (metric != nullptr && !metric_properties.empty()) {
+      metric->Properties(std::move(metric_properties));
+    }
+    metric_properties = MetricPropertyList();
+  };
+  for (StoredProperty& stored : property_list) {
+    if (metric == nullptr || stored.metric_id != metric_id) {
+      publish();
+      metric_id = stored.metric_id;
+      auto itr = id_list.find(stored.metric_id);
+      metric = itr != id_list.end() ? itr->second : nullptr;
+    }
+    metric_properties.Insert(std::move(stored.property));
+  }
+  publish();
+
+  // The restored values are already in the file
+  auto snapshot = Snapshot();
+  std::scoped_lock lock(db_mutex_);
+  flushed_ = std::move(snapshot);
+  return true;
+}
+
+bool SqliteDatabase::Save() {
+  // The values are saved from a snapshot, so the next flush only writes
+  // later changes.
+  auto snapshot = Snapshot();
+  std::scoped_lock lock(db_mutex_);
+  if (db_ == nullptr) {
+    return false;
+  }
+  Statement insert_group(db_, kInsertGroup);
+  Statement insert_metric(db_, kInsertMetric);
+  Statement insert_property(db_, kInsertProperty);
+  if (!insert_group.IsOk() || !insert_metric.IsOk() ||
+      !insert_property.IsOk() || !Execute("BEGIN IMMEDIATE")) {
+    return false;
+  }
+
+  bool ok = Execute("DELETE FROM metric_property;"
+                    "DELETE FROM metric;"
+                    "DELETE FROM metric_group;");
+  ForEachGroup([&](const MetricGroup& group) {
+    if (!ok) {
+      return;
+    }
+    insert_group.Bind(1, group.Name());
+    insert_group.Bind(2, group.Identity());
+    insert_group.Bind(3, static_cast<int64_t>(group.Type()));
+    insert_group.Bind(4, group.Description());
+    ok = insert_group.Execute();
+  });
+
+  // A metric created after its group was saved, is restored with a default
+  // group by the import.
+  int64_t metric_id = 0;
+  ForEachMetric([&](const Metric& metric) {
+    if (!ok) {
+      return;
+    }
+    ++metric_id;
+    insert_metric.Bind(1, metric_id);
+    insert_metric.Bind(2, metric.GroupName());
+    insert_metric.Bind(3, metric.GroupIdentity());
+    insert_metric.Bind(4, metric.Name());
+    // The type is bound with the value, which may be older than the live
+    // type of the metric.
+    if (const SnapshotValue* item = snapshot->Get(metric.Handle());
+        item != nullptr) {
+      insert_metric.Bind(5, static_cast<int64_t>(item->type));
+      BindValue(insert_metric, 6, *item);
+      insert_metric.Bind(7, static_cast<int64_t>(item->timestamp));
+      insert_metric.Bind(8, static_cast<int64_t>(item->valid ? 1 : 0));
+    } else {
+      insert_metric.Bind(5, static_cast<int64_t>(metric.DataType()));
+      insert_metric.BindNull(6);
+      insert_metric.Bind(7, int64_t{0});
+      insert_metric.Bind(8, int64_t{0});
+    }
+    ok = insert_metric.Execute();
+
+    // The property strings are owned by the list, which is immutable
+    const auto property_list = metric.Properties();
+    for (const MetricProperty& property : *property_list) {
+      if (!ok) {
+        break;
+      }
+      insert_property.Bind(1, metric_id);
+      insert_property.Bind(2, property.Key());
+      insert_property.Bind(3, static_cast<int64_t>(property.DataType()));
+      insert_property.Bind(4, static_cast<int64_t>(property.IsNull() ? 1 : 0));
+      insert_property.BindCopy(5, property.Value<std::string>());
+      ok = insert_property.Execute();
+    }
+  });
+
+  if (!ok || !Execute("COMMIT")) {
+    Execute("ROLLBACK");
+    return false;
+  }
+  flushed_ = std::move(snapshot);
+  return true;
+}
+
+size_t SqliteDatabase::FlushValues() {
+  auto snapshot = Snapshot();
+  std::scoped_lock lock(db_mutex_);
+  if (db_ == nullptr || snapshot == flushed_) {
+    return 0;
+  }
+  // The statement is prepared once per connection, as a flush is frequent
+  if (upsert_value_ == nullptr) {
+    upsert_value_ = PrepareCached(db_, kUpsertValue);
+  }
+  Statement upsert_value(upsert_value_);
+  if (!upsert_value.IsOk() || !Execute("BEGIN IMMEDIATE")) {
+    return 0;
+  }
+
+  // The metrics may be deleted by other threads while they are written
+  auto guard = Pin();
+  size_t nof_values = 0;
+  bool ok = true;
+  snapshot->ForEachChanged(flushed_.get(), [&](const SnapshotValue& item) {
+    const Metric* metric = GetMetric(item.handle);
+    if (!ok || metric == nullptr) {
+      return;
+    }
+    upsert_value.Bind(1, metric->GroupName());
+    upsert_value.Bind(2, metric->GroupIdentity());
+    upsert_value.Bind(3, metric->Name());
+    upsert_value.Bind(4, static_cast<int64_t>(item.type));
+    BindValue(upsert_value, 5, item);
+    upsert_value.Bind(6, static_cast<int64_t>(item.timestamp));
+    upsert_value.Bind(7, static_cast<int64_t>(item.valid ? 1 : 0));
+    ok = upsert_value.Execute();
+    ++nof_values;
+  });
+
+  if (!ok || !Execute("COMMIT")) {
+    Execute("ROLLBACK");
+    return 0;
+  }
+  flushed_ = std::move(snapshot);
+  return nof_values;
+}
+
+void SqliteDatabase::StartFlush() {
+  if (flush_thread_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(flush_mutex_);
+    stop_flush_ = false;
+  }
+  flush_thread_ = std::thread(&SqliteDatabase::FlushTask, this);
+}
+
+void SqliteDatabase::StopFlush() {
+  if (!flush_thread_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(flush_mutex_);
+    stop_flush_ = true;
+  }
+  flush_condition_.notify_all();
+  flush_thread_.join();
+  FlushValues();
+}
+
+void SqliteDatabase::FlushInterval(std::chrono::milliseconds interval) {
+  std::scoped_lock lock(flush_mutex_);
+  flush_interval_ = interval;
+}
+
+std::chrono::milliseconds SqliteDatabase::FlushInterval() const {
+  std::scoped_lock lock(flush_mutex_);
+  return flush_interval_;
+}
+
+void SqliteDatabase::FlushTask() {
+  std::unique_lock lock(flush_mutex_);
+  while (!stop_flush_) {
+    flush_condition_.wait_for(lock, flush_interval_,
+                              [&] { return stop_flush_; });
+    if (stop_flush_) {
+      break;
+    }
+    lock.unlock();
+    FlushValues();
+    lock.lock();
+  }
+}
+
+}  // namespace metric
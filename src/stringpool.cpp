@@ -0,0 +1,91 @@
+/*
+ * Copyright 2025 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metric/stringpool.h"
+
+#include <cstring>
+#include <new>
+
+namespace metric {
+
+StringPool::~StringPool() {
+  // The characters are released with the buffer
+  for (const std::string_view text : string_list_) {
+    std::destroy_at(&HeaderOf(text));
+  }
+}
+
+StringPool& StringPool::Global() {
+  // Never destroyed, see the declaration
+  static auto* global_pool = new StringPool;
+  return *global_pool;
+}
+
+StringPool::Header& StringPool::HeaderOf(std::string_view text) {
+  return *std::launder(reinterpret_cast<Header*>(
+      const_cast<char*>(text.data()) - sizeof(Header)));
+}
+
+std::string_view StringPool::Intern(std::string_view text) {
+  std::scoped_lock lock(pool_mutex_);
+  if (auto itr = string_list_.find(text); itr != string_list_.end()) {
+    HeaderOf(*itr).count.fetch_add(1, std::memory_order_relaxed);
+    return *itr;
+  }
+  void* block = buffer_.allocate(sizeof(Header) + text.size() + 1,
+                                 alignof(Header));
+  auto* header = ::new (block) Header;
+  header->count.store(1, std::memory_order_relaxed);
+  auto* data = reinterpret_cast<char*>(header) + sizeof(Header);
+  if (!text.empty()) {
+    std::memcpy(data, text.data(), text.size());
+  }
+  data[text.size()] = '\0';
+  auto [itr, inserted] = string_list_.emplace(data, text.size());
+  return *itr;
+}
+
+void StringPool::Retain(std::string_view text) {
+  if (text.data() != nullptr) {
+    HeaderOf(text).count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void StringPool::Release(std::string_view text) {
+  if (text.data() == nullptr) {
+    return;
+  }
+  // Only the last reference needs the lock. A count of one can only be
+  // increased by Intern(), which holds the lock.
+  Header& header = HeaderOf(text);
+  size_t count = header.count.load(std::memory_order_relaxed);
+  while (count > 1) {
+    if (header.count.compare_exchange_weak(count, count - 1,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  std::scoped_lock lock(pool_mutex_);
+  if (header.count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  string_list_.erase(text);
+  std::destroy_at(&header);
+  buffer_.deallocate(&header, sizeof(Header) + text.size() + 1,
+                     alignof(Header));
+}
+
+void StringPool::Reserve(size_t count) {
+  std::scoped_lock lock(pool_mutex_);
+  string_list_.reserve(string_list_.size() + count);
+}
+
+size_t StringPool::Size() const {
+  std::scoped_lock lock(pool_mutex_);
+  return string_list_.size();
+}
+
+}  // namespace metric
@@ -0,0 +1,251 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "dbcparser.h"
+#include "metric/dbcdatabase.h"
+
+using namespace metric;
+
+namespace {
+
+constexpr std::string_view kDbcText = R"(VERSION ""
+
+NS_ :
+	NS_DESC_
+	CM_
+	BA_DEF_
+	SIG_VALTYPE_
+
+BS_:
+
+BU_: Engine Gateway
+
+BO_ 100 EngineData: 8 Engine
+ SG_ Speed : 0|16@1+ (0.1,0) [0|6553.5] "km/h" Gateway
+ SG_ Temperature : 16|8@1- (1,-40) [-40|215] "degC" Gateway
+ SG_ Running : 24|1@1+ (1,0) [0|1] "" Gateway
+ SG_ Torque : 39|32@0- (1,0) [0|0] "Nm" Gateway
+
+BO_ 2566844926 ExtendedFrame: 8 Gateway
+ SG_ Mode M : 0|8@1+ (1,0) [0|255] "" Engine
+ SG_ Value m1 : 8|16@1+ (1,0) [0|65535] "" Engine
+
+BO_ 3221225472 VECTOR__INDEPENDENT_SIG_MSG: 0 Vector__XXX
+ SG_ Unused : 0|8@1+ (1,0) [0|0] "" Vector__XXX
+
+CM_ "The database comment";
+CM_ BU_ Engine "The engine node";
+CM_ BO_ 100 "Engine data";
+CM_ SG_ 100 Speed "Vehicle speed
+with a \"quoted\" text";
+BA_DEF_ SG_  "GenSigStartValue" INT 0 10000;
+VAL_ 100 Running 0 "Off" 1 "On" ;
+SIG_VALTYPE_ 100 Torque : 1;
+)";
+
+std::string TestFile(const std::string& name, std::string_view text) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << text;
+  return path.string();
+}
+
+}  // namespace
+
+TEST(DbcParser, TestParse) {
+  DbcParser parser(kDbcText);
+  ASSERT_TRUE(parser.Parse());
+  const auto& message_list = parser.Messages();
+  ASSERT_EQ(message_list.size(), 3);
+
+  const auto& engine = message_list[0];
+  EXPECT_EQ(engine.id, 100);
+  EXPECT_EQ(engine.name, "EngineData");
+  EXPECT_EQ(engine.dlc, 8);
+  EXPECT_EQ(engine.comment, "Engine data");
+  ASSERT_EQ(engine.signal_list.size(), 4);
+
+  const auto& speed = engine.signal_list[0];
+  EXPECT_EQ(speed.name, "Speed");
+  EXPECT_EQ(speed.length, 16);
+  EXPECT_TRUE(speed.little_endian);
+  EXPECT_FALSE(speed.is_signed);
+  EXPECT_DOUBLE_EQ(speed.factor, 0.1);
+  EXPECT_DOUBLE_EQ(speed.max, 6553.5);
+  EXPECT_EQ(speed.unit, "km/h");
+  EXPECT_EQ(DbcParser::Unescape(speed.comment),
+            "Vehicle speed\nwith a \"quoted\" text");
+  EXPECT_EQ(speed.DataType(), MetricType::Double);
+
+  const auto& temperature = engine.signal_list[1];
+  EXPECT_TRUE(temperature.is_signed);
+  EXPECT_DOUBLE_EQ(temperature.offset, -40.0);
+  EXPECT_EQ(temperature.DataType(), MetricType::Int64);
+
+  EXPECT_EQ(engine.signal_list[2].DataType(), MetricType::Boolean);
+
+  const auto& torque = engine.signal_list[3];
+  EXPECT_EQ(torque.start_bit, 39);
+  EXPECT_FALSE(torque.little_endian);
+  EXPECT_TRUE(torque.is_float);
+  EXPECT_EQ(torque.DataType(), MetricType::Double);
+
+  const auto& extended = message_list[1];
+  EXPECT_EQ(extended.CanId(), 0x18FEF1FE);
+  ASSERT_EQ(extended.signal_list.size(), 2);
+  EXPECT_EQ(extended.signal_list[0].DataType(), MetricType::UInt8);
+  EXPECT_EQ(extended.signal_list[1].name, "Value");
+  EXPECT_EQ(extended.signal_list[1].DataType(), MetricType::UInt16);
+}
+
+TEST(DbcParser, TestInvalidSignal) {
+  constexpr std::string_view text =
+      "BO_ 100 EngineData: 8 Engine\n"
+      " SG_ Speed : 0|16@1+ (0.1,0) [0|6553.5] \"km/h\" Gateway\n"
+      " SG_ Temperature : 16|8@1- (1,-40 [-40|215] \"degC\" Gateway\n";
+  DbcParser parser(text);
+  EXPECT_FALSE(parser.Parse());
+  EXPECT_EQ(parser.ErrorLine(), 3);
+}
+
+TEST(DbcParser, TestScaledType) {
+  constexpr std::string_view text =
+      "BO_ 100 Counters: 8 Engine\n"
+      " SG_ Raw : 0|64@1+ (1,0) [0|0] \"\" Gateway\n"
+      " SG_ Offset : 0|64@1+ (1,10) [0|0] \"\" Gateway\n"
+      " SG_ Shifted : 0|63@1+ (1,10) [0|0] \"\" Gateway\n"
+      " SG_ Double : 0|32@1+ (2,0) [0|0] \"\" Gateway\n"
+      " SG_ Negative : 0|32@1+ (-1,0) [0|0] \"\" Gateway\n";
+  DbcParser parser(text);
+  ASSERT_TRUE(parser.Parse());
+  const auto& signal_list = parser.Messages()[0].signal_list;
+  ASSERT_EQ(signal_list.size(), 5);
+  EXPECT_EQ(signal_list[0].DataType(), MetricType::UInt64);
+  // The scaled range doesn't fit in a 64-bit integer
+  EXPECT_EQ(signal_list[1].DataType(), MetricType::Double);
+  // The scaled range is above the signed range
+  EXPECT_EQ(signal_list[2].DataType(), MetricType::UInt64);
+  EXPECT_EQ(signal_list[3].DataType(), MetricType::Int64);
+  EXPECT_EQ(signal_list[4].DataType(), MetricType::Int64);
+}
+
+TEST(DbcDatabase, TestLoad) {
+  DbcDatabase database;
+  EXPECT_EQ(database.Type(), TypeOfDatabase::DbcFile);
+  database.Filename(TestFile("test_metric.dbc", kDbcText));
+  database.Enable(true);
+  ASSERT_TRUE(database.IsOperable());
+  EXPECT_EQ(database.Groups().size(), 2);
+  EXPECT_EQ(database.Metrics().size(), 6);
+
+  const auto* group = database.GetGroupByIdentity(100);
+  ASSERT_TRUE(group != nullptr);
+  EXPECT_EQ(group->Name(), "EngineData");
+  EXPECT_EQ(group->Type(), TypeOfGroup::CanMessage);
+  EXPECT_EQ(group->Description(), "Engine data");
+  EXPECT_TRUE(database.GetGroupByIdentity(0x18FEF1FE) != nullptr);
+
+  const auto* speed = database.GetMetricByGroupIdentity(100, "Speed");
+  ASSERT_TRUE(speed != nullptr);
+  EXPECT_EQ(speed->DataType(), MetricType::Double);
+  EXPECT_EQ(speed->Unit(), "km/h");
+  EXPECT_EQ(speed->Description(), "Vehicle speed\nwith a \"quoted\" text");
+  const auto factor = speed->GetProperty("factor");
+  ASSERT_TRUE(factor != nullptr);
+  EXPECT_EQ(factor->DataType(), MetricType::Double);
+  EXPECT_DOUBLE_EQ(factor->Value<double>(), 0.1);
+  const auto length = speed->GetProperty("length");
+  ASSERT_TRUE(length != nullptr);
+  EXPECT_EQ(length->Value<uint32_t>(), 16);
+
+  const auto* torque = database.GetMetricByGroupIdentity(100, "Torque");
+  ASSERT_TRUE(torque != nullptr);
+  EXPECT_EQ(torque->GetProperty("byte_order")->Value<std::string>(),
+            "big_endian");
+  EXPECT_TRUE(database.GetMetricByGroupIdentity(0x18FEF1FE, "Value") !=
+              nullptr);
+  // Empty texts aren't stored
+  EXPECT_TRUE(torque->GetProperty("description") == nullptr);
+  const auto* running = database.GetMetricByGroupIdentity(100, "Running");
+  ASSERT_TRUE(running != nullptr);
+  EXPECT_TRUE(running->GetProperty("unit") == nullptr);
+  EXPECT_EQ(running->Properties()->size(), 7);
+
+  // The existing metrics are kept
+  EXPECT_TRUE(database.Load());
+  EXPECT_EQ(database.Metrics().size(), 6);
+  EXPECT_EQ(database.MetricsByName().size(), 6);
+  const auto engine_list = database.MetricsByGroupIdentity(100);
+  ASSERT_EQ(engine_list.size(), 4);
+  EXPECT_EQ(engine_list[0]->Name(), "Running");
+  EXPECT_EQ(engine_list[3]->Name(), "Torque");
+
+  database.Enable(false);
+  DbcDatabase duplicate;
+  duplicate.Filename(TestFile("test_metric_duplicate.dbc",
+                              "BO_ 100 EngineData: 8 Engine\n"
+                              " SG_ Speed : 0|16@1+ (1,0) [0|0] \"\" Node\n"
+                              " SG_ Speed : 16|8@1+ (1,0) [0|0] \"\" Node\n"));
+  ASSERT_TRUE(duplicate.Load());
+  EXPECT_EQ(duplicate.Metrics().size(), 1);
+
+  DbcDatabase missing;
+  missing.Filename(TestFile("test_metric_missing.dbc", "") + ".none");
+  missing.Enable(true);
+  EXPECT_FALSE(missing.IsOperable());
+}
+
+TEST(DbcDatabase, TestLoadSpeed) {
+  // About the size of the DBC file of a complete vehicle, with unique
+  // signal names and a comment on every fourth signal
+  constexpr size_t kMessages = 1'500;
+  constexpr size_t kSignals = 64;
+  std::string text =
+      "VERSION \"\"\n\nNS_ :\n\tCM_\n\nBS_:\n\nBU_: Engine Gateway\n\n";
+  for (size_t message = 0; message < kMessages; ++message) {
+    const std::string frame = "Frame" + std::to_string(message);
+    text += "BO_ " + std::to_string(message) + " " + frame + ": 8 Engine\n";
+    for (size_t signal = 0; signal < kSignals; ++signal) {
+      text += " SG_ " + frame + "_Signal" + std::to_string(signal) + " : " +
+              std::to_string(signal) +
+              "|16@1+ (0.01,-40) [-40|615.35] \"km/h\" Gateway\n";
+    }
+    text += '\n';
+  }
+  for (size_t message = 0; message < kMessages; ++message) {
+    for (size_t signal = 0; signal < kSignals; signal += 4) {
+      text += "CM_ SG_ " + std::to_string(message) + " Frame" +
+              std::to_string(message) + "_Signal" + std::to_string(signal) +
+              " \"Measured value of the signal\";\n";
+    }
+  }
+  const std::string filename = TestFile("test_metric_speed.dbc", text);
+
+  DbcDatabase database;
+  database.Filename(filename);
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(database.Load());
+  const std::chrono::duration<double, std::milli> load_time =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(database.Groups().size(), kMessages);
+  EXPECT_EQ(database.Metrics().size(), kMessages * kSignals);
+
+  const double megabytes = static_cast<double>(text.size()) / 1'000'000.0;
+  const double signal_time = load_time.count() * 1'000.0 /
+                             static_cast<double>(kMessages * kSignals);
+  std::cout << "DBC: " << megabytes << " MB, Load: " << load_time.count()
+            << " ms, " << megabytes * 1000.0 / load_time.count() << " MB/s, "
+            << signal_time << " us/signal" << std::endl;
+}
@@ -3,7 +3,15 @@
 * SPDX-License-Identifier: MIT
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -13,12 +21,10 @@
 using namespace metric;
 
 TEST(Metric, TestProperties) {
-  Metric metric;
-  metric.Name("Donald");
+  Metric metric("Disney", 12, "Donald");
   EXPECT_EQ(metric.Name(), "Donald");
-
-  metric.GroupName("Disney");
   EXPECT_EQ(metric.GroupName(), "Disney");
+  EXPECT_EQ(metric.GroupIdentity(), 12);
 
   metric.Identity(0x1234);
   EXPECT_EQ(metric.Identity(), 0x1234);
@@ -72,20 +78,20 @@ TEST(Metric, TestProperties) {
     metric.ReadOnly(false);
     EXPECT_FALSE(metric.IsReadOnly());
 
-    EXPECT_EQ(metric.Properties().size(), 2); // Description, Unit should exist
+    EXPECT_EQ(metric.Properties()->size(), 2); // Description, Unit should exist
     MetricProperty partner_prop("Partner","Goofy");
     metric.AddProperty(partner_prop);
-    EXPECT_EQ(metric.Properties().size(), 3);
+    EXPECT_EQ(metric.Properties()->size(), 3);
     EXPECT_TRUE(metric.GetProperty("Partner") != nullptr);
     metric.DeleteProperty("Partner");
-    EXPECT_EQ(metric.Properties().size(), 2);
+    EXPECT_EQ(metric.Properties()->size(), 2);
 
-    const auto* goofy_prop = metric.CreateProperty("Partner");
+    const auto goofy_prop = metric.CreateProperty("Partner");
     EXPECT_TRUE(goofy_prop != nullptr);
-    EXPECT_EQ(metric.Properties().size(), 3);
+    EXPECT_EQ(metric.Properties()->size(), 3);
     EXPECT_TRUE(metric.GetProperty("Partner") != nullptr);
     metric.DeleteProperty("Partner");
-    EXPECT_EQ(metric.Properties().size(), 2);
+    EXPECT_EQ(metric.Properties()->size(), 2);
 
     metric.SetUpdated();
     EXPECT_TRUE(metric.IsUpdated());
@@ -142,4 +148,420 @@ TEST(Metric, TestValues) {
   metric.Value(date_string);
   EXPECT_EQ(metric.Value<uint64_t>(), 0);
 
-}
\ No newline at end of file
+}
+
+TEST(Metric, TestNativeValues) {
+  Metric metric;
+
+  metric.DataType(MetricType::Int8);
+  metric.Value(300);
+  EXPECT_EQ(metric.Value<int>(), static_cast<int8_t>(300));
+
+  metric.DataType(MetricType::Double);
+  metric.ResetUpdated();
+  metric.Value(1.5);
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<std::string>(), "1.5");
+  EXPECT_EQ(metric.Value<int>(), 1);
+
+  metric.ResetUpdated();
+  metric.Value(1.5);
+  EXPECT_FALSE(metric.IsUpdated());
+
+  metric.Value("2.25 V");
+  EXPECT_TRUE(metric.IsValid());
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<double>(), 2.25);
+
+  metric.Value("Goofy");
+  EXPECT_FALSE(metric.IsValid());
+  EXPECT_EQ(metric.Value<double>(), 2.25);
+
+  // Change of data type converts the existing value
+  metric.DataType(MetricType::String);
+  EXPECT_EQ(metric.Value<std::string>(), "2.25");
+  metric.DataType(MetricType::Float);
+  EXPECT_EQ(metric.Value<float>(), 2.25F);
+}
+
+
+TEST(Metric, TestConcurrentRead) {
+  // One writer toggles the data type between Int64 and Double while
+  // incrementing the value. A reader must never see a torn type/value pair,
+  // i.e. the values must be monotonic and within the written range.
+  const auto max_readers = std::max(4U, std::thread::hardware_concurrency());
+  double single_rate = 0.0;
+  for (unsigned readers = 1; readers <= max_readers; readers *= 2) {
+    Metric metric;
+    metric.DataType(MetricType::Int64);
+    metric.Value<int64_t>(0);
+
+    std::atomic<bool> stop = false;
+    std::atomic<bool> failed = false;
+    std::atomic<uint64_t> nof_reads = 0;
+
+    std::vector<std::thread> reader_list;
+    for (unsigned reader = 0; reader < readers; ++reader) {
+      reader_list.emplace_back([&] {
+        uint64_t count = 0;
+        int64_t last = 0;
+        while (!stop) {
+          const auto value = metric.Value<int64_t>();
+          if (value < last) {
+            failed = true;
+          }
+          last = value;
+          ++count;
+        }
+        nof_reads += count;
+      });
+    }
+
+    int64_t written = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::milliseconds(100);
+    while (std::chrono::steady_clock::now() < end) {
+      ++written;
+      metric.DataType(written % 2 == 0 ? MetricType::Int64
+                                       : MetricType::Double);
+      metric.Value(written);
+    }
+    stop = true;
+    for (auto& reader : reader_list) {
+      reader.join();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(metric.Value<int64_t>(), written);
+
+    const double rate = static_cast<double>(nof_reads) / elapsed.count();
+    if (readers == 1) {
+      single_rate = rate;
+    }
+    std::cout << "Readers: " << readers
+              << ", Reads/s: " << static_cast<uint64_t>(rate)
+              << ", Scaling: " << (single_rate > 0 ? rate / single_rate : 0)
+              << ", Writes/s: "
+              << static_cast<uint64_t>(written / elapsed.count())
+              << std::endl;
+  }
+}
+
+TEST(Metric, TestArrays) {
+  Metric metric;
+  metric.DataType(MetricType::Int16Array);
+  const std::vector<int16_t> int_list = {1, -2, 3};
+  metric.ResetUpdated();
+  metric.Array(int_list);
+  EXPECT_TRUE(metric.IsValid());
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.ArraySize(), 3);
+  const auto int_copy = metric.Array<int16_t>();
+  ASSERT_EQ(int_copy.size(), 3);
+  EXPECT_TRUE(std::ranges::equal(int_copy, int_list));
+  EXPECT_TRUE(metric.Array<int32_t>().empty());
+
+  // The copy isn't changed by a later write
+  std::vector<int16_t> dest = {9, 9, 9, 9};
+  EXPECT_EQ(metric.CopyArray(dest), 3);
+  EXPECT_EQ(dest, int_list);
+  EXPECT_EQ(metric.Value<std::string>(), "1,-2,3");
+  EXPECT_EQ(metric.Value<int>(), 1);
+
+  metric.ResetUpdated();
+  metric.Array(int_list);
+  EXPECT_FALSE(metric.IsUpdated());
+
+  // Other element types are converted
+  const std::vector<double> double_list = {1.0, -2.0, 4.0};
+  metric.Array(double_list);
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.Array<int16_t>()[2], 4);
+
+  metric.Value("5, 6");
+  EXPECT_TRUE(metric.IsValid());
+  ASSERT_EQ(metric.ArraySize(), 2);
+  EXPECT_EQ(metric.Array<int16_t>()[1], 6);
+  EXPECT_EQ(int_copy[2], 3);
+
+  metric.DataType(MetricType::DoubleArray);
+  ASSERT_EQ(metric.ArraySize(), 2);
+  EXPECT_EQ(metric.Array<double>()[0], 5.0);
+
+  metric.DataType(MetricType::StringArray);
+  const std::vector<std::string> string_list = {"Donald", "Duck"};
+  metric.Array(string_list);
+  EXPECT_EQ(metric.Value<std::string>(), "Donald,Duck");
+  EXPECT_EQ(metric.Array<std::string>().size(), 2);
+
+  metric.DataType(MetricType::Double);
+  metric.Array(double_list);
+  EXPECT_FALSE(metric.IsValid());
+}
+
+TEST(Metric, TestArraySpeed) {
+  constexpr size_t kElements = 4'096;
+  constexpr int kLoops = 1'000;
+  std::vector<double> wave(kElements);
+
+  Metric metric;
+  metric.DataType(MetricType::DoubleArray);
+  const auto array_start = std::chrono::steady_clock::now();
+  for (int loop = 0; loop < kLoops; ++loop) {
+    for (size_t index = 0; index < kElements; ++index) {
+      wave[index] = static_cast<double>(loop + index) * 0.5;
+    }
+    metric.Array(wave);
+  }
+  const std::chrono::duration<double, std::micro> array_time =
+      std::chrono::steady_clock::now() - array_start;
+  EXPECT_EQ(metric.Array<double>()[1], wave[1]);
+
+  metric.DataType(MetricType::String);
+  std::string text;
+  const auto text_start = std::chrono::steady_clock::now();
+  for (int loop = 0; loop < kLoops / 10; ++loop) {
+    text.clear();
+    for (size_t index = 0; index < kElements; ++index) {
+      if (index > 0) {
+        text += ',';
+      }
+      text += std::to_string(static_cast<double>(loop + index) * 0.5);
+    }
+    metric.Value(text);
+  }
+  const std::chrono::duration<double, std::micro> text_time =
+      std::chrono::steady_clock::now() - text_start;
+  std::cout << "Array: " << array_time.count() / kLoops << " us/update"
+            << ", Text: " << text_time.count() / (kLoops / 10)
+            << " us/update" << std::endl;
+}
+
+TEST(Metric, TestDeadband) {
+  Metric metric;
+  metric.DataType(MetricType::Double);
+  metric.Deadband(0.5);
+  EXPECT_EQ(metric.Deadband(), 0.5);
+
+  metric.Value(10.0);
+  EXPECT_EQ(metric.AcceptedUpdates(), 1);
+  metric.ResetUpdated();
+
+  metric.Value(10.4); // Noise
+  EXPECT_FALSE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<double>(), 10.0);
+  EXPECT_EQ(metric.SuppressedUpdates(), 1);
+
+  metric.Value(10.6);
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<double>(), 10.6);
+  EXPECT_EQ(metric.AcceptedUpdates(), 2);
+
+  metric.Deadband(0.0);
+  metric.PercentDeadband(10.0);
+  metric.ResetUpdated();
+  metric.Value(11.0); // Less than 10% of 10.6
+  EXPECT_FALSE(metric.IsUpdated());
+  metric.Value("12.0");
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<double>(), 12.0);
+
+  metric.PercentDeadband(0.0);
+  metric.MinInterval(100);
+  metric.ResetUpdateCounters();
+  metric.ResetUpdated();
+  metric.Timestamp(1000);
+  metric.Value(1.0);
+  EXPECT_TRUE(metric.IsUpdated());
+  metric.ResetUpdated();
+  metric.Timestamp(1050);
+  metric.Value(2.0);
+  EXPECT_FALSE(metric.IsUpdated());
+  metric.Timestamp(1100);
+  metric.Value(3.0);
+  EXPECT_TRUE(metric.IsUpdated());
+  EXPECT_EQ(metric.AcceptedUpdates(), 2);
+  EXPECT_EQ(metric.SuppressedUpdates(), 1);
+
+  // A counter reset doesn't reset the filters
+  metric.MinInterval(0);
+  metric.Deadband(0.5);
+  metric.ResetUpdateCounters();
+  metric.ResetUpdated();
+  metric.Value(3.2);
+  EXPECT_FALSE(metric.IsUpdated());
+  EXPECT_EQ(metric.Value<double>(), 3.0);
+  EXPECT_EQ(metric.SuppressedUpdates(), 1);
+
+  // A type conversion isn't a sample
+  metric.ResetUpdateCounters();
+  metric.DataType(MetricType::String);
+  metric.DataType(MetricType::Int32);
+  EXPECT_EQ(metric.Value<int>(), 3);
+  EXPECT_EQ(metric.AcceptedUpdates(), 0);
+  EXPECT_EQ(metric.SuppressedUpdates(), 0);
+}
+
+TEST(Metric, TestLayout) {
+  // The per-sample state starts on its own cache line and metrics never
+  // share a cache line.
+  EXPECT_EQ(alignof(Metric), kCacheLineSize);
+  EXPECT_EQ(sizeof(Metric) % kCacheLineSize, 0);
+
+  std::cout << "sizeof(Metric): " << sizeof(Metric)
+            << ", alignof(Metric): " << alignof(Metric)
+            << ", sizeof(ValueSlot): " << sizeof(ValueSlot)
+            << ", sizeof(MetricProperty): " << sizeof(MetricProperty)
+            << ", sizeof(std::recursive_mutex): "
+            << sizeof(std::recursive_mutex) << std::endl;
+}
+
+TEST(Metric, TestConcurrentUpdate) {
+  // Each thread updates every n:th metric in an array, so without padding
+  // the threads write to the same cache lines.
+  constexpr size_t kMetrics = 64;
+  constexpr int kUpdates = 200'000;
+  const auto metric_list = std::make_unique<Metric[]>(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    metric_list[index].DataType(MetricType::Int64);
+  }
+
+  for (size_t nof_threads : {1, 2, 4}) {
+    std::vector<std::thread> thread_list;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t thread = 0; thread < nof_threads; ++thread) {
+      thread_list.emplace_back([&, thread] {
+        for (int update = 0; update < kUpdates; ++update) {
+          for (size_t index = thread; index < kMetrics; index += nof_threads) {
+            Metric& metric = metric_list[index];
+            metric.Timestamp(static_cast<uint64_t>(update));
+            metric.Value(update);
+          }
+        }
+      });
+    }
+    for (auto& thread : thread_list) {
+      thread.join();
+    }
+    const std::chrono::duration<double, std::nano> time =
+        std::chrono::steady_clock::now() - start;
+    const auto nof_updates = static_cast<double>(kUpdates) * kMetrics;
+    std::cout << "Threads: " << nof_threads
+              << ", Update: " << time.count() / nof_updates << " ns"
+              << std::endl;
+  }
+  EXPECT_EQ(metric_list[0].Value<int>(), kUpdates - 1);
+}
+
+TEST(Metric, TestConcurrentProperties) {
+  Metric metric;
+  metric.Unit("m");
+  std::atomic<bool> stop = false;
+  std::atomic<bool> failed = false;
+
+  std::thread reader([&] {
+    while (!stop) {
+      if (metric.Unit() != "m") {
+        failed = true;
+      }
+      const auto property_list = metric.Properties();
+      if (property_list->Find("unit") == nullptr) {
+        failed = true;
+      }
+    }
+  });
+  for (int index = 0; index < 1'000; ++index) {
+    metric.Description("Description " + std::to_string(index));
+  }
+  stop = true;
+  reader.join();
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(metric.Description(), "Description 999");
+  EXPECT_EQ(metric.Properties()->size(), 2);
+
+  // A held property outlives the change while an unused list is freed
+  const auto description = metric.GetProperty("description");
+  const std::weak_ptr<const MetricPropertyList> old_list = metric.Properties();
+  metric.Description("New description");
+  EXPECT_EQ(description->Value<std::string>(), "Description 999");
+  EXPECT_FALSE(old_list.expired());
+  const std::weak_ptr<const MetricPropertyList> unused_list =
+      metric.Properties();
+  metric.Unit("km");
+  EXPECT_TRUE(unused_list.expired());
+}
+
+TEST(Metric, TestMove) {
+  static_assert(std::is_nothrow_move_constructible_v<Metric>);
+  static_assert(std::is_nothrow_move_assignable_v<Metric>);
+
+  Metric source("Group", 11, "Speed");
+  source.DataType(MetricType::Double);
+  source.Historical(true);
+  source.Timestamp(1'000);
+  source.Value(1.5);
+  source.Unit("m/s");
+  MetricProperty set("set", "");
+  set.PropertyArray().resize(2);
+  set.PropertyArray()[1].Insert(MetricProperty("min", "0"));
+  source.AddProperty(std::move(set));
+  const auto unit = source.GetProperty("unit");
+  const auto history = source.History();
+
+  Metric dest = std::move(source);
+  EXPECT_EQ(dest.Name(), "Speed");
+  EXPECT_EQ(dest.GroupName(), "Group");
+  EXPECT_EQ(dest.GroupIdentity(), 11);
+  EXPECT_EQ(dest.DataType(), MetricType::Double);
+  EXPECT_DOUBLE_EQ(dest.Value<double>(), 1.5);
+  EXPECT_EQ(dest.Timestamp(), 1'000);
+  EXPECT_TRUE(dest.IsValid());
+  EXPECT_TRUE(dest.IsUpdated());
+  // The properties and history are transferred, not copied
+  EXPECT_EQ(dest.GetProperty("unit"), unit);
+  EXPECT_EQ(dest.History(), history);
+  const auto nested = dest.GetProperty("set");
+  ASSERT_TRUE(nested != nullptr);
+  ASSERT_EQ(nested->PropertyArray().size(), 2);
+  EXPECT_EQ(nested->PropertyArray()[1].Find("min")->Value<int>(), 0);
+
+  EXPECT_TRUE(source.Name().empty());
+  EXPECT_TRUE(source.Properties()->empty());
+  EXPECT_TRUE(source.History() == nullptr);
+  EXPECT_FALSE(source.IsValid());
+
+  Metric text;
+  text.Value(std::string("Hello"));
+  dest = std::move(text);
+  EXPECT_EQ(dest.Value<std::string>(), "Hello");
+  EXPECT_TRUE(dest.Properties()->empty());
+
+  // A movable metric can be stored by value
+  std::vector<Metric> metric_list;
+  for (int index = 0; index < 100; ++index) {
+    auto& metric = metric_list.emplace_back("Group", 1,
+                                            "M" + std::to_string(index));
+    metric.DataType(MetricType::Int32);
+    metric.Value(index);
+  }
+  EXPECT_EQ(metric_list[50].Name(), "M50");
+  EXPECT_EQ(metric_list[50].Value<int>(), 50);
+}
+
+TEST(Metric, TestMoveColumn) {
+  MetricColumns columns;
+  Metric source;
+  source.DataType(MetricType::Int32);
+  source.Column(&columns, 7);
+  source.Value(42);
+
+  Metric dest = std::move(source);
+  EXPECT_EQ(dest.Value<int>(), 42);
+  dest.Value(43);
+  MetricType type = MetricType::Unknown;
+  NativeValue value;
+  columns.ChunkOf(7).value[MetricColumns::OffsetOf(7)].Load(type, value);
+  EXPECT_EQ(type, MetricType::Int32);
+  EXPECT_EQ(value.signed_value, 43);
+}
@@ -0,0 +1,103 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metricarena.h"
+#include "metric/metricdatabase.h"
+
+using namespace metric;
+
+TEST(MetricArena, TestCreate) {
+  MetricArena arena;
+  auto metric1 = arena.Create<Metric>("Group", 1, "Metric 1");
+  auto metric2 = arena.Create<Metric>("Group", 1, "Metric 2");
+  ASSERT_TRUE(metric1);
+  ASSERT_TRUE(metric2);
+  EXPECT_EQ(metric1->Name(), "Metric 1");
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(metric1.get()) % alignof(Metric), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(metric2.get()) % alignof(Metric), 0);
+  EXPECT_EQ(arena.Allocated(), 2 * sizeof(Metric));
+
+  // The block of a deleted object is reused by the next object
+  Metric* block = metric1.get();
+  metric1.reset();
+  EXPECT_EQ(arena.FreeBlocks(), 1);
+  auto metric3 = arena.Create<Metric>("Group", 1, "Metric 3");
+  EXPECT_EQ(metric3.get(), block);
+  EXPECT_EQ(arena.FreeBlocks(), 0);
+  EXPECT_EQ(arena.Allocated(), 2 * sizeof(Metric));
+
+  auto group = arena.Create<MetricGroup>();
+  group->Name("Group");
+  EXPECT_EQ(arena.Allocated(), 2 * sizeof(Metric) + sizeof(MetricGroup));
+}
+
+TEST(MetricArena, TestResource) {
+  MetricArena arena;
+  const void* block = nullptr;
+  {
+    std::pmr::vector<Metric*> metric_list(arena.Resource());
+    metric_list.resize(100);
+    block = metric_list.data();
+  }
+  // A freed container block is reused by the next container
+  std::pmr::vector<Metric*> metric_list(arena.Resource());
+  metric_list.resize(100);
+  EXPECT_EQ(metric_list.data(), block);
+  EXPECT_EQ(arena.Allocated(), 0);
+}
+
+TEST(MetricArena, TestDatabase) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  const auto* metric1 = database.CreateMetric(*group, "Metric 1");
+  const auto* metric2 = database.CreateMetric(*group, "Metric 2");
+  // The metrics of a group are created in one block
+  EXPECT_EQ(metric2, metric1 + 1);
+
+  database.DeleteMetric(*group, "Metric 1");
+  MetricGroup orphan;
+  orphan.Name("Orphan");
+  const auto* metric3 = database.CreateMetric(orphan, "Metric 3");
+  // The deleted metric's memory is reused
+  EXPECT_EQ(metric3, metric1);
+  EXPECT_EQ(database.Metrics().size(), 2);
+}
+
+TEST(MetricArena, TestDatabaseSpeed) {
+  constexpr size_t kMetrics = 200'000;
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    definition_list.push_back({"Group " + std::to_string(index / 100),
+                               static_cast<int32_t>(index / 100),
+                               "Metric " + std::to_string(index),
+                               MetricType::Double, "", ""});
+  }
+
+  const auto create_start = std::chrono::steady_clock::now();
+  auto database = std::make_unique<MetricDatabase>();
+  EXPECT_EQ(database->ImportMetrics(definition_list), kMetrics);
+  const auto destroy_start = std::chrono::steady_clock::now();
+  database.reset();
+  const auto stop = std::chrono::steady_clock::now();
+
+  const std::chrono::duration<double, std::milli> create_time =
+      destroy_start - create_start;
+  const std::chrono::duration<double, std::milli> destroy_time =
+      stop - destroy_start;
+  std::cout << "Metrics: " << kMetrics
+            << ", Create: " << create_time.count() << " ms"
+            << ", Destroy: " << destroy_time.count() << " ms" << std::endl;
+}
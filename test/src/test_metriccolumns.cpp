@@ -0,0 +1,143 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metriccolumns.h"
+#include "metric/metricdatabase.h"
+
+using namespace metric;
+
+TEST(MetricColumns, TestColumns) {
+  MetricColumns columns;
+  EXPECT_EQ(columns.Rows(), 0);
+
+  auto* chunk = columns.Reserve(MetricColumns::kChunkSize + 1);
+  ASSERT_TRUE(chunk != nullptr);
+  EXPECT_EQ(columns.Rows(), 2 * MetricColumns::kChunkSize);
+  EXPECT_EQ(&columns.ChunkOf(MetricColumns::kChunkSize), chunk);
+
+  chunk->timestamp[1] = 1234;
+  chunk->valid[1] = true;
+  columns.Reset(MetricColumns::kChunkSize + 1);
+  EXPECT_EQ(chunk->timestamp[1], 0);
+  EXPECT_FALSE(chunk->valid[1]);
+
+  size_t nof_rows = 0;
+  columns.ForEach([&](uint32_t, MetricType, NativeValue, uint64_t, bool) {
+    ++nof_rows;
+  });
+  EXPECT_EQ(nof_rows, columns.Rows());
+}
+
+TEST(MetricColumns, TestMetric) {
+  MetricColumns columns;
+  Metric metric("Godzillas", 1, "Godzilla");
+  metric.DataType(MetricType::Double);
+  metric.Timestamp(1000);
+  metric.Value(1.5);
+
+  // The state is copied to the row
+  metric.Column(&columns, 5);
+  const auto& chunk = columns.ChunkOf(5);
+  EXPECT_EQ(chunk.timestamp[5], 1000);
+  EXPECT_TRUE(chunk.valid[5]);
+  EXPECT_EQ(chunk.value[5].Type(), MetricType::Double);
+
+  metric.Timestamp(2000);
+  metric.Value(2.5);
+  EXPECT_EQ(chunk.timestamp[5], 2000);
+  EXPECT_EQ(metric.Value<double>(), 2.5);
+
+  // and back to the metric
+  metric.Column(nullptr, 0);
+  columns.Reset(5);
+  EXPECT_EQ(metric.Timestamp(), 2000);
+  EXPECT_EQ(metric.Value<double>(), 2.5);
+  EXPECT_TRUE(metric.IsValid());
+}
+
+TEST(MetricColumns, TestDatabase) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Godzillas", 101);
+  auto* godzilla1 = database.CreateMetric(*group, "Godzilla 1");
+  godzilla1->DataType(MetricType::Int32);
+  godzilla1->Value(11);
+
+  database.Columnar(true);
+  EXPECT_TRUE(database.IsColumnar());
+  auto* godzilla2 = database.CreateMetric(*group, "Godzilla 2");
+  godzilla2->DataType(MetricType::Int32);
+  godzilla2->Value(22);
+  auto* godzilla3 = database.CreateMetric(*group, "Godzilla 3");
+  database.DeleteMetric(*group, "Godzilla 3");
+  EXPECT_EQ(godzilla1->Value<int>(), 11);
+
+  int64_t sum = 0;
+  size_t count = 0;
+  database.ForEachValue([&](MetricHandle handle, MetricType type,
+                            NativeValue value, uint64_t, bool valid) {
+    EXPECT_TRUE(database.GetMetric(handle) != nullptr);
+    EXPECT_EQ(type, MetricType::Int32);
+    EXPECT_TRUE(valid);
+    sum += value.signed_value;
+    ++count;
+  });
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(sum, 33);
+
+  database.Columnar(false);
+  EXPECT_FALSE(database.IsColumnar());
+  EXPECT_EQ(godzilla2->Value<int>(), 22);
+  std::ignore = godzilla3;
+}
+
+TEST(MetricColumns, TestScanSpeed) {
+  constexpr size_t kMetrics = 200'000;
+  constexpr size_t kScans = 20;
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    MetricDefinition definition;
+    definition.group_name = "Frame " + std::to_string(index / 50);
+    definition.group_identity = static_cast<int32_t>(index / 50);
+    definition.name = "Signal " + std::to_string(index);
+    definition.data_type = MetricType::Double;
+    definition_list.push_back(std::move(definition));
+  }
+  MetricDatabase database;
+  database.ImportMetrics(definition_list);
+  for (const auto& metric : database.Metrics()) {
+    metric->Timestamp(1000);
+    metric->Value(1.0);
+  }
+
+  const auto scan = [&]() -> double {
+    double sum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t count = 0; count < kScans; ++count) {
+      database.ForEachValue([&](MetricHandle, MetricType, NativeValue value,
+                                uint64_t, bool) {
+        sum += value.double_value;
+      });
+    }
+    const std::chrono::duration<double, std::nano> time =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(sum, static_cast<double>(kMetrics * kScans));
+    return time.count() / (kMetrics * kScans);
+  };
+
+  const double object_time = scan();
+  database.Columnar(true);
+  const double column_time = scan();
+  std::cout << "Metrics: " << kMetrics
+            << ", Object scan: " << object_time << " ns/metric"
+            << ", Column scan: " << column_time << " ns/metric" << std::endl;
+}
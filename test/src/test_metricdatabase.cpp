@@ -3,7 +3,16 @@
 * SPDX-License-Identifier: MIT
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -45,6 +54,21 @@ TEST(MetricDatabase, TestProperties) {
   EXPECT_EQ(database.Metrics().size(),1);
   database.DeleteMetric(*godzilla_group, "Godzilla");
   EXPECT_EQ(database.Metrics().size(),0);
+
+  // The last metric takes the place of a deleted metric
+  for (int index = 0; index < 4; ++index) {
+    std::ignore = database.CreateMetric(*godzilla_group,
+                                        "Godzilla " + std::to_string(index));
+  }
+  database.DeleteMetric(*godzilla_group, "Godzilla 1");
+  ASSERT_EQ(database.Metrics().size(), 3);
+  EXPECT_EQ(database.Metrics()[0]->Name(), "Godzilla 0");
+  EXPECT_EQ(database.Metrics()[1]->Name(), "Godzilla 3");
+  EXPECT_EQ(database.Metrics()[2]->Name(), "Godzilla 2");
+  database.DeleteMetric(*godzilla_group, "Godzilla 3");
+  database.DeleteMetric(*godzilla_group, "Godzilla 2");
+  ASSERT_EQ(database.Metrics().size(), 1);
+  EXPECT_EQ(database.Metrics()[0]->Name(), "Godzilla 0");
 }
 
 TEST(MetricDatabase, TestTypeConversion) {
@@ -140,4 +164,559 @@ TEST(MetricDatabase, TestAccess) {
 
   EXPECT_EQ(database.MetricsByGroupIdentity(102).size(), 2);
   EXPECT_EQ(database.MetricsByGroupName("Godzillas")[0], metric4);
-}
\ No newline at end of file
+}
+
+TEST(MetricDatabase, TestDrainUpdated) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Godzillas", 101);
+  ASSERT_TRUE(group != nullptr);
+  for (int index = 0; index < 100; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Godzilla " + std::to_string(index));
+    ASSERT_TRUE(metric != nullptr);
+    metric->DataType(MetricType::Int32);
+  }
+  std::vector<Metric*> updated_list;
+  EXPECT_EQ(database.DrainUpdated(updated_list), 0);
+
+  auto* godzilla = database.GetMetricByGroupName("Godzillas", "Godzilla 10");
+  ASSERT_TRUE(godzilla != nullptr);
+  godzilla->Value(10);
+  ASSERT_EQ(database.DrainUpdated(updated_list), 1);
+  EXPECT_EQ(updated_list[0], godzilla);
+  EXPECT_FALSE(godzilla->IsUpdated());
+
+  godzilla->Value(11);
+  database.DeleteMetric(*group, "Godzilla 10");
+  EXPECT_EQ(database.DrainUpdated(updated_list), 0);
+}
+
+namespace {
+
+class CountingDatabase : public MetricDatabase {
+ public:
+  size_t nof_notifications = 0;
+ protected:
+  void OnUpdate(size_t) override { ++nof_notifications; }
+};
+
+}  // namespace
+
+TEST(MetricDatabase, TestUpdateBatch) {
+  CountingDatabase database;
+  const auto* group = database.CreateGroup("CAN Frame", 0x123);
+  ASSERT_TRUE(group != nullptr);
+  std::vector<Metric*> signal_list;
+  for (int index = 0; index < 64; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Signal " + std::to_string(index));
+    ASSERT_TRUE(metric != nullptr);
+    metric->DataType(MetricType::Double);
+    signal_list.push_back(metric);
+  }
+
+  std::vector<MetricUpdate> update_list;
+  for (size_t index = 0; index < signal_list.size(); ++index) {
+    update_list.emplace_back(signal_list[index]->Handle(),
+                             static_cast<int>(index) + 1);
+  }
+  update_list.emplace_back(signal_list[0]->Handle(), 100.5, 1234);
+  update_list.emplace_back(MetricHandle(), 1);
+
+  EXPECT_EQ(database.UpdateBatch(update_list), 65);
+  EXPECT_EQ(database.nof_notifications, 1);
+  EXPECT_EQ(signal_list[0]->Value<double>(), 100.5);
+  EXPECT_EQ(signal_list[0]->Timestamp(), 1234);
+  EXPECT_EQ(signal_list[1]->Value<double>(), 2.0);
+  EXPECT_GT(signal_list[1]->Timestamp(), 0);
+
+  // No changes, no notification
+  update_list.resize(signal_list.size());
+  update_list[0] = MetricUpdate(signal_list[0]->Handle(), 100.5);
+  EXPECT_EQ(database.UpdateBatch(update_list), 0);
+  EXPECT_EQ(database.nof_notifications, 1);
+
+  std::vector<Metric*> updated_list;
+  EXPECT_EQ(database.DrainUpdated(updated_list), signal_list.size());
+}
+
+TEST(MetricDatabase, TestUpdateBatchSpeed) {
+  constexpr int kSignals = 64;
+  constexpr int kFrames = 10'000;
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("CAN Frame", 0x123);
+  std::vector<Metric*> signal_list;
+  for (int index = 0; index < kSignals; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Signal " + std::to_string(index));
+    metric->DataType(MetricType::Double);
+    signal_list.push_back(metric);
+  }
+
+  const auto single_start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int index = 0; index < kSignals; ++index) {
+      const auto now = std::chrono::system_clock::now();
+      signal_list[index]->Timestamp(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              now.time_since_epoch()).count()));
+      signal_list[index]->Value(frame + index);
+    }
+  }
+  const std::chrono::duration<double, std::nano> single_time =
+      std::chrono::steady_clock::now() - single_start;
+
+  std::vector<MetricUpdate> update_list(kSignals);
+  const auto batch_start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int index = 0; index < kSignals; ++index) {
+      update_list[index] = MetricUpdate(signal_list[index]->Handle(),
+                                        frame + index + 1);
+    }
+    database.UpdateBatch(update_list);
+  }
+  const std::chrono::duration<double, std::nano> batch_time =
+      std::chrono::steady_clock::now() - batch_start;
+
+  constexpr double kSamples = static_cast<double>(kSignals) * kFrames;
+  std::cout << "Single: " << single_time.count() / kSamples << " ns/sample"
+            << ", Batch: " << batch_time.count() / kSamples << " ns/sample"
+            << std::endl;
+}
+
+TEST(MetricDatabase, TestHandle) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Godzillas", 101);
+  ASSERT_TRUE(group != nullptr);
+  EXPECT_TRUE(database.GetMetric(MetricHandle()) == nullptr);
+
+  auto* godzilla1 = database.CreateMetric(*group, "Godzilla 1");
+  auto* godzilla2 = database.CreateMetric(*group, "Godzilla 2");
+  ASSERT_TRUE(godzilla1 != nullptr && godzilla2 != nullptr);
+  const MetricHandle handle1 = godzilla1->Handle();
+  const MetricHandle handle2 = godzilla2->Handle();
+  EXPECT_TRUE(handle1.IsValid());
+  EXPECT_NE(handle1, handle2);
+  EXPECT_EQ(database.GetMetric(handle1), godzilla1);
+  EXPECT_EQ(database.GetMetric(handle2), godzilla2);
+
+  // The deleted metric's slot is reused with a new generation
+  database.DeleteMetric(*group, "Godzilla 1");
+  EXPECT_TRUE(database.GetMetric(handle1) == nullptr);
+  auto* godzilla3 = database.CreateMetric(*group, "Godzilla 3");
+  ASSERT_TRUE(godzilla3 != nullptr);
+  const MetricHandle handle3 = godzilla3->Handle();
+  EXPECT_EQ(handle3.Index(), handle1.Index());
+  EXPECT_NE(handle3.Generation(), handle1.Generation());
+  EXPECT_TRUE(database.GetMetric(handle1) == nullptr);
+  EXPECT_EQ(database.GetMetric(handle3), godzilla3);
+  EXPECT_EQ(database.GetMetric(handle2), godzilla2);
+}
+
+TEST(MetricDatabase, TestDuplicate) {
+  MetricDatabase database;
+  auto* group1 = database.CreateGroup("Godzillas", 101);
+  auto* group2 = database.CreateGroup("Mothras", 102);
+  EXPECT_EQ(database.CreateGroup("Godzillas", 101), group1);
+  EXPECT_EQ(database.Groups().size(), 2);
+
+  auto* metric1 = database.CreateMetric(*group1, "Size");
+  auto* metric2 = database.CreateMetric(*group2, "Size");
+  EXPECT_NE(metric1, metric2);
+  EXPECT_EQ(database.CreateMetric(*group1, "Size"), metric1);
+  EXPECT_EQ(database.Metrics().size(), 2);
+
+  EXPECT_EQ(database.GetMetricByGroupName("Mothras", "Size"), metric2);
+  EXPECT_EQ(database.GetMetricByGroupIdentity(101, "Size"), metric1);
+
+  database.DeleteMetric(*group1, "Size");
+  EXPECT_TRUE(database.GetMetricByGroupName("Godzillas", "Size") == nullptr);
+  EXPECT_EQ(database.GetMetricByGroupName("Mothras", "Size"), metric2);
+
+  database.DeleteGroup("Mothras", 102);
+  EXPECT_TRUE(database.GetGroupByName("Mothras") == nullptr);
+  EXPECT_TRUE(database.GetGroupByIdentity(102) == nullptr);
+  EXPECT_EQ(database.GetGroupByIdentity(101), group1);
+}
+
+TEST(MetricDatabase, TestLookupSpeed) {
+  constexpr size_t kMetricsPerGroup = 100;
+  constexpr size_t kLookups = 100'000;
+  for (size_t nof_metrics : {10'000, 100'000, 1'000'000}) {
+    MetricDatabase database;
+    const auto create_start = std::chrono::steady_clock::now();
+    for (size_t index = 0; index < nof_metrics; ++index) {
+      const auto group_index = index / kMetricsPerGroup;
+      const auto* group = database.CreateGroup(
+          "Group " + std::to_string(group_index),
+          static_cast<int32_t>(group_index));
+      database.CreateMetric(*group, "Metric " + std::to_string(index));
+    }
+    const std::chrono::duration<double, std::milli> create_time =
+        std::chrono::steady_clock::now() - create_start;
+
+    // Prepare the names so the loop only measures the lookups
+    std::vector<std::pair<std::string, std::string>> key_list;
+    for (size_t lookup = 0; lookup < kLookups; ++lookup) {
+      const size_t index = (lookup * 7919) % nof_metrics;
+      key_list.emplace_back("Group " + std::to_string(index / kMetricsPerGroup),
+                            "Metric " + std::to_string(index));
+    }
+
+    size_t nof_found = 0;
+    const auto lookup_start = std::chrono::steady_clock::now();
+    for (const auto& [group_name, metric_name] : key_list) {
+      if (database.GetMetricByGroupName(group_name, metric_name) != nullptr) {
+        ++nof_found;
+      }
+    }
+    const std::chrono::duration<double, std::nano> lookup_time =
+        std::chrono::steady_clock::now() - lookup_start;
+    EXPECT_EQ(nof_found, kLookups);
+
+    // A few linear scans as a reference to the old implementation
+    constexpr size_t kScans = 10;
+    const auto scan_start = std::chrono::steady_clock::now();
+    for (size_t scan = 0; scan < kScans; ++scan) {
+      const auto& [group_name, metric_name] = key_list[scan];
+      const auto itr = std::ranges::find_if(database.Metrics(),
+                                            [&](const auto& metric) {
+        return metric->GroupName() == group_name &&
+               metric->Name() == metric_name;
+      });
+      EXPECT_TRUE(itr != database.Metrics().end());
+    }
+    const std::chrono::duration<double, std::nano> scan_time =
+        std::chrono::steady_clock::now() - scan_start;
+
+    std::cout << "Metrics: " << nof_metrics
+              << ", Create: " << create_time.count() << " ms"
+              << ", Lookup: " << lookup_time.count() / kLookups << " ns"
+              << ", Linear: " << scan_time.count() / kScans << " ns"
+              << std::endl;
+  }
+}
+
+TEST(MetricDatabase, TestImportMetrics) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Godzillas", 101);
+  database.CreateMetric(*group, "Godzilla 1");
+
+  std::vector<MetricDefinition> definition_list = {
+      {"Godzillas", 101, "Godzilla 1", MetricType::Double, "m", ""},
+      {"Godzillas", 101, "Godzilla 2", MetricType::Double, "m", "Height"},
+      {"Godzillas", 101, "Godzilla 2", MetricType::Int32, "", ""},
+      {"King Kongs", 102, "King Kong 1", MetricType::Int32, "kg", ""},
+  };
+  EXPECT_EQ(database.ImportMetrics(definition_list), 2);
+  EXPECT_EQ(database.Groups().size(), 2);
+  EXPECT_EQ(database.Metrics().size(), 3);
+
+  const auto* godzilla2 =
+      database.GetMetricByGroupName("Godzillas", "Godzilla 2");
+  ASSERT_TRUE(godzilla2 != nullptr);
+  EXPECT_EQ(godzilla2->DataType(), MetricType::Double);
+  EXPECT_EQ(godzilla2->Unit(), "m");
+  EXPECT_EQ(godzilla2->Description(), "Height");
+  EXPECT_EQ(database.GetMetric(godzilla2->Handle()), godzilla2);
+
+  const auto* king_kong1 = database.GetMetricByGroupIdentity(102,
+                                                             "King Kong 1");
+  ASSERT_TRUE(king_kong1 != nullptr);
+  EXPECT_EQ(king_kong1->GroupName(), "King Kongs");
+  EXPECT_EQ(database.ImportMetrics(definition_list), 0);
+
+  // The moving import transfers the strings into the properties
+  std::vector<MetricDefinition> move_list = {
+      {"King Kongs", 102, "King Kong 2", MetricType::Int32, "kg",
+       "Weight of the second King Kong"},
+  };
+  EXPECT_EQ(database.ImportMetrics(std::move(move_list)), 1);
+  const auto* king_kong2 = database.GetMetricByGroupName("King Kongs",
+                                                         "King Kong 2");
+  ASSERT_TRUE(king_kong2 != nullptr);
+  EXPECT_EQ(king_kong2->Unit(), "kg");
+  EXPECT_EQ(king_kong2->Description(), "Weight of the second King Kong");
+}
+
+TEST(MetricDatabase, TestImportSpeed) {
+  constexpr size_t kMetrics = 200'000;
+  constexpr size_t kMetricsPerGroup = 50;
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    const auto group_index = index / kMetricsPerGroup;
+    MetricDefinition definition;
+    definition.group_name = "Frame " + std::to_string(group_index);
+    definition.group_identity = static_cast<int32_t>(group_index);
+    definition.name = "Signal " + std::to_string(index);
+    definition.data_type = MetricType::Double;
+    definition_list.push_back(std::move(definition));
+  }
+
+  MetricDatabase single_database;
+  const auto single_start = std::chrono::steady_clock::now();
+  for (const auto& definition : definition_list) {
+    const auto* group = single_database.CreateGroup(definition.group_name,
+                                                    definition.group_identity);
+    auto* metric = single_database.CreateMetric(*group, definition.name);
+    metric->DataType(definition.data_type);
+  }
+  const std::chrono::duration<double, std::milli> single_time =
+      std::chrono::steady_clock::now() - single_start;
+
+  MetricDatabase bulk_database;
+  const auto bulk_start = std::chrono::steady_clock::now();
+  EXPECT_EQ(bulk_database.ImportMetrics(definition_list), kMetrics);
+  const std::chrono::duration<double, std::milli> bulk_time =
+      std::chrono::steady_clock::now() - bulk_start;
+  EXPECT_EQ(bulk_database.Metrics().size(), single_database.Metrics().size());
+
+  std::cout << "Metrics: " << kMetrics
+            << ", CreateMetric: " << single_time.count() << " ms"
+            << ", ImportMetrics: " << bulk_time.count() << " ms" << std::endl;
+}
+
+TEST(MetricDatabase, TestSortSpeed) {
+  constexpr size_t kMetrics = 100'000;
+  constexpr size_t kMetricsPerGroup = 50;
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    // Unsorted input
+    const size_t number = (index * 7919) % kMetrics;
+    const auto group_index = number / kMetricsPerGroup;
+    MetricDefinition definition;
+    definition.group_name = "Frame " + std::to_string(group_index);
+    definition.group_identity = static_cast<int32_t>(group_index);
+    definition.name = "Signal " + std::to_string(number);
+    definition_list.push_back(std::move(definition));
+  }
+  MetricDatabase database;
+  database.ImportMetrics(definition_list);
+
+  const auto group_start = std::chrono::steady_clock::now();
+  database.SortMetricsByGroup();
+  const std::chrono::duration<double, std::milli> group_time =
+      std::chrono::steady_clock::now() - group_start;
+
+  const auto name_start = std::chrono::steady_clock::now();
+  database.SortMetricsByName();
+  const std::chrono::duration<double, std::milli> name_time =
+      std::chrono::steady_clock::now() - name_start;
+
+  const auto& metric_list = database.Metrics();
+  EXPECT_TRUE(std::ranges::is_sorted(metric_list, [](const auto& metric1,
+                                                     const auto& metric2) {
+    return metric1->Name() < metric2->Name();
+  }));
+  std::cout << "Metrics: " << kMetrics
+            << ", SortMetricsByGroup: " << group_time.count() << " ms"
+            << ", SortMetricsByName: " << name_time.count() << " ms"
+            << std::endl;
+}
+
+TEST(MetricDatabase, TestConcurrent) {
+  constexpr int kMetrics = 1'000;
+  constexpr int kReaders = 4;
+  MetricDatabase database;
+  database.Concurrent(true);
+  EXPECT_TRUE(database.IsConcurrent());
+  const auto* group = database.CreateGroup("Group", 1);
+  for (int index = 0; index < kMetrics; ++index) {
+    database.CreateMetric(*group, "Metric " + std::to_string(index));
+  }
+
+  // The readers look up the stable metrics, while the main thread creates
+  // and deletes other metrics.
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> nof_misses = 0;
+  std::atomic<size_t> nof_lookups = 0;
+  std::vector<std::thread> reader_list;
+  for (int reader = 0; reader < kReaders; ++reader) {
+    reader_list.emplace_back([&, reader] {
+      size_t lookups = 0;
+      for (int index = reader; !stop; index = (index + 1) % kMetrics) {
+        auto guard = database.Pin();
+        const std::string name = "Metric " + std::to_string(index);
+        const Metric* metric1 = database.GetMetricByGroupName("Group", name);
+        const Metric* metric2 = database.GetMetricByGroupIdentity(1, name);
+        if (metric1 == nullptr || metric1 != metric2 ||
+            database.GetMetric(metric1->Handle()) != metric1 ||
+            database.GetGroupByName("Group") == nullptr) {
+          ++nof_misses;
+        }
+        ++lookups;
+      }
+      nof_lookups += lookups;
+    });
+  }
+  // The locked listings never see a half created or deleted metric
+  reader_list.emplace_back([&] {
+    while (!stop) {
+      size_t count = 0;
+      database.ForEachMetric([&](const Metric& metric) {
+        count += metric.GroupName() == "Group" ? 1 : 0;
+      });
+      size_t sorted = 0;
+      database.ForEachMetricByName([&](const Metric&) { ++sorted; });
+      size_t groups = 0;
+      database.ForEachGroup([&](const MetricGroup&) { ++groups; });
+      if (count < kMetrics || sorted < kMetrics || groups == 0 ||
+          database.MetricList().size() < kMetrics ||
+          database.GroupList().empty()) {
+        ++nof_misses;
+      }
+    }
+  });
+
+  for (int loop = 0; loop < 2'000; ++loop) {
+    const std::string name = "Temporary " + std::to_string(loop / 2 % 100);
+    if (loop % 2 == 0) {
+      database.CreateMetric(*group, name);
+      database.CreateGroup("Group " + std::to_string(loop % 10), loop % 10);
+    } else {
+      database.DeleteMetric(*group, name);
+    }
+  }
+  stop = true;
+  for (auto& reader : reader_list) {
+    reader.join();
+  }
+  EXPECT_EQ(nof_misses, 0);
+  EXPECT_GT(nof_lookups, 0);
+  EXPECT_EQ(database.MetricsByGroupIdentity(1).size(), kMetrics);
+  std::cout << "Lookups: " << nof_lookups << std::endl;
+}
+
+TEST(MetricDatabase, TestUpdateGroup) {
+  MetricDatabase database;
+  auto* frame = database.CreateGroup("Frame", 0x100);
+  frame->Type(TypeOfGroup::CanMessage);
+  auto* other = database.CreateGroup("Other", 0x200);
+  std::vector<MetricUpdate> update_list;
+  for (int index = 0; index < 4; ++index) {
+    auto* signal = database.CreateMetric(*frame,
+                                         "Signal " + std::to_string(index));
+    signal->DataType(MetricType::Int32);
+    update_list.emplace_back(signal->Handle(), index * 10 + 1);
+  }
+  auto* other_signal = database.CreateMetric(*other, "Signal 0");
+  update_list.emplace_back(other_signal->Handle(), 99);
+  ASSERT_EQ(frame->Metrics().size(), 4);
+  for (size_t index = 0; index < frame->Metrics().size(); ++index) {
+    EXPECT_EQ(frame->Metrics()[index], frame->Metrics()[0] + index);
+    EXPECT_EQ(frame->Metrics()[index]->Group(), frame);
+  }
+
+  EXPECT_EQ(database.UpdateGroup(*frame, update_list, 5000), 4);
+  EXPECT_EQ(frame->Timestamp(), 5000);
+  EXPECT_FALSE(other_signal->IsValid());
+
+  std::vector<SnapshotValue> value_list;
+  ASSERT_EQ(database.ReadGroup(*frame, value_list), 4);
+  for (size_t index = 0; index < value_list.size(); ++index) {
+    EXPECT_EQ(value_list[index].handle, frame->Metrics()[index]->Handle());
+    EXPECT_EQ(value_list[index].value.signed_value,
+              static_cast<int64_t>(index * 10 + 1));
+    EXPECT_EQ(value_list[index].timestamp, 5000);
+    EXPECT_TRUE(value_list[index].valid);
+  }
+
+  // A single value write is also a frame write
+  const uint64_t sequence = frame->ReadBegin();
+  frame->Metrics()[0]->Value(7);
+  EXPECT_TRUE(frame->ReadRetry(sequence));
+  EXPECT_EQ(frame->Timestamp(), 5000);
+
+  {
+    // The pin keeps the deleted metric alive
+    const auto guard = database.Pin();
+    const auto* signal3 = frame->Metrics()[3];
+    database.DeleteMetric(*frame, "Signal 3");
+    EXPECT_EQ(signal3->Group(), nullptr);
+  }
+  EXPECT_EQ(frame->Metrics().size(), 3);
+  EXPECT_EQ(database.ReadGroup(*frame, value_list), 3);
+}
+
+TEST(MetricDatabase, TestGroupStorage) {
+  // The definitions are interleaved, but the metrics of a group are still
+  // created next to each other.
+  std::vector<MetricDefinition> definition_list;
+  for (int index = 0; index < 100; ++index) {
+    const int group_index = index % 4;
+    definition_list.push_back({"Frame " + std::to_string(group_index),
+                               group_index, "Signal " + std::to_string(index),
+                               MetricType::Double, "", ""});
+  }
+  MetricDatabase database;
+  database.Columnar(true);
+  EXPECT_EQ(database.ImportMetrics(definition_list), 100);
+  for (const auto& group : database.Groups()) {
+    const auto metric_list = group->Metrics();
+    ASSERT_EQ(metric_list.size(), 25);
+    for (size_t index = 1; index < metric_list.size(); ++index) {
+      EXPECT_EQ(metric_list[index]->Handle().Index(),
+                metric_list[index - 1]->Handle().Index() + 1);
+    }
+  }
+}
+
+TEST(MetricDatabase, TestConsistentFrames) {
+  constexpr int kSignals = 8;
+  MetricDatabase database;
+  database.Concurrent(true);
+  auto* frame = database.CreateGroup("Frame", 0x100);
+  std::vector<MetricHandle> handle_list;
+  for (int index = 0; index < kSignals; ++index) {
+    auto* signal = database.CreateMetric(*frame,
+                                         "Signal " + std::to_string(index));
+    signal->DataType(MetricType::Int64);
+    handle_list.push_back(signal->Handle());
+  }
+  // Written one value at a time by another thread
+  auto* counter = database.CreateMetric(*frame, "Counter");
+  counter->DataType(MetricType::UInt64);
+
+  // Each frame sets all signals to the frame number. A reader must never
+  // see signals from different frames.
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> nof_torn = 0;
+  std::atomic<size_t> nof_reads = 0;
+  std::thread writer([&] {
+    for (uint64_t count = 1; !stop; ++count) {
+      counter->Value(count);
+    }
+  });
+  std::thread reader([&] {
+    std::vector<SnapshotValue> value_list;
+    while (!stop) {
+      database.ReadGroup(*frame, value_list);
+      for (int index = 0; index < kSignals; ++index) {
+        const SnapshotValue& value = value_list[index];
+        if (value.value.signed_value != value_list[0].value.signed_value ||
+            value.timestamp != value_list[0].timestamp) {
+          ++nof_torn;
+          break;
+        }
+      }
+      ++nof_reads;
+    }
+  });
+
+  std::vector<MetricUpdate> update_list(kSignals);
+  for (int64_t sample = 1; sample <= 20'000; ++sample) {
+    for (int index = 0; index < kSignals; ++index) {
+      update_list[index] = MetricUpdate(handle_list[index], sample);
+    }
+    database.UpdateGroup(*frame, update_list, 1000 + sample);
+  }
+  stop = true;
+  writer.join();
+  reader.join();
+  EXPECT_EQ(nof_torn, 0);
+  EXPECT_GT(counter->Value<uint64_t>(), 0);
+  EXPECT_GT(nof_reads, 0);
+  std::cout << "Frame reads: " << nof_reads << std::endl;
+}
@@ -0,0 +1,168 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metricdatabase.h"
+#include "metric/metricepoch.h"
+
+using namespace metric;
+
+TEST(MetricEpoch, TestPin) {
+  MetricEpoch epoch;
+  EXPECT_EQ(epoch.Readers(), 0);
+  uint64_t retire_epoch = 0;
+  {
+    auto guard = epoch.Pin();
+    EXPECT_EQ(epoch.Readers(), 1);
+    retire_epoch = epoch.Advance();
+    EXPECT_FALSE(epoch.IsSafe(retire_epoch));
+
+    // A reader that pins after the advance doesn't block the delete
+    std::thread reader([&] {
+      auto reader_guard = epoch.Pin();
+      EXPECT_EQ(epoch.Readers(), 2);
+    });
+    reader.join();
+    EXPECT_FALSE(epoch.IsSafe(retire_epoch));
+  }
+  EXPECT_TRUE(epoch.IsSafe(retire_epoch));
+  EXPECT_EQ(epoch.Readers(), 0);
+
+  auto guard = epoch.Pin();
+  EXPECT_TRUE(epoch.IsSafe(retire_epoch));
+  EXPECT_FALSE(epoch.IsSafe(epoch.Advance()));
+}
+
+TEST(MetricEpoch, TestDeleteMetric) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  auto* metric = database.CreateMetric(*group, "Metric 1");
+  metric->DataType(MetricType::Int32);
+  metric->Value(11);
+  const MetricHandle handle = metric->Handle();
+  {
+    auto guard = database.Pin();
+    database.DeleteMetric(*group, "Metric 1");
+
+    // Logically deleted but still usable by the pinned thread
+    EXPECT_TRUE(database.GetMetric(handle) == nullptr);
+    EXPECT_TRUE(database.GetMetricByGroupName("Group", "Metric 1") == nullptr);
+    EXPECT_EQ(database.Retired(), 1);
+    EXPECT_EQ(metric->Value<int>(), 11);
+    metric->Value(12);
+    EXPECT_EQ(metric->Value<int>(), 12);
+
+    // The handle slot isn't reused while the metric may be used
+    const auto* metric2 = database.CreateMetric(*group, "Metric 2");
+    EXPECT_NE(metric2->Handle().Index(), handle.Index());
+    EXPECT_EQ(database.Reclaim(), 0);
+  }
+  EXPECT_EQ(database.Reclaim(), 1);
+  EXPECT_EQ(database.Retired(), 0);
+
+  // The updated but deleted metric isn't returned by the update queue
+  std::vector<Metric*> updated_list;
+  database.DrainUpdated(updated_list);
+  for (const auto* updated : updated_list) {
+    EXPECT_NE(updated, metric);
+  }
+
+  database.DeleteGroup("Group", 1);
+  EXPECT_TRUE(database.GetGroupByName("Group") == nullptr);
+  EXPECT_EQ(database.Retired(), 0);
+}
+
+TEST(MetricEpoch, TestConcurrentDelete) {
+  constexpr int kMetrics = 100;
+  constexpr int kLoops = 200;
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  std::vector<MetricHandle> handle_list;
+  for (int index = 0; index < kMetrics; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    handle_list.push_back(metric->Handle());
+  }
+
+  // The writer resolves the handles and updates the metrics, while the
+  // main thread deletes every other metric.
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> nof_updates = 0;
+  std::thread writer([&] {
+    for (int64_t sample = 0; !stop; ++sample) {
+      auto guard = database.Pin();
+      for (const MetricHandle handle : handle_list) {
+        if (Metric* metric = database.GetMetric(handle); metric != nullptr) {
+          metric->Value(sample);
+          ++nof_updates;
+        }
+      }
+    }
+  });
+
+  for (int loop = 0; loop < kLoops; ++loop) {
+    const std::string name = "Metric " + std::to_string((loop * 2) % kMetrics);
+    database.DeleteMetric(*group, name);
+    std::this_thread::yield();
+  }
+  stop = true;
+  writer.join();
+  database.Reclaim();
+  EXPECT_EQ(database.Retired(), 0);
+  EXPECT_EQ(database.Metrics().size(), kMetrics / 2);
+  std::cout << "Updates: " << nof_updates << std::endl;
+}
+
+TEST(MetricEpoch, TestBatchDelete) {
+  constexpr int kMetrics = 100;
+  constexpr int kLoops = 200;
+  MetricDatabase database;
+  database.Concurrent(true);
+  auto* group = database.CreateGroup("Group", 1);
+  std::vector<MetricUpdate> update_list;
+  for (int index = 0; index < kMetrics; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    update_list.emplace_back(metric->Handle(), int64_t{0});
+  }
+
+  // The batch updates pin the epoch themselves, so the writer has no pin
+  // while the main thread deletes every other metric
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> nof_changes = 0;
+  std::thread writer([&] {
+    for (int64_t sample = 1; !stop; ++sample) {
+      for (MetricUpdate& update : update_list) {
+        update.value = ToNative(sample);
+      }
+      nof_changes += sample % 2 == 0 ? database.UpdateBatch(update_list)
+                                     : database.UpdateGroup(*group,
+                                                            update_list);
+    }
+  });
+  while (nof_changes == 0) {
+    std::this_thread::yield();
+  }
+
+  for (int loop = 0; loop < kLoops; ++loop) {
+    const std::string name = "Metric " + std::to_string((loop * 2) % kMetrics);
+    database.DeleteMetric(*group, name);
+    std::this_thread::yield();
+  }
+  stop = true;
+  writer.join();
+  database.Reclaim();
+  EXPECT_EQ(database.Retired(), 0);
+  EXPECT_EQ(database.Metrics().size(), kMetrics / 2);
+}
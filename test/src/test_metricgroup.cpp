@@ -26,4 +26,17 @@ TEST(MetricGroup, TestProperties) {
   group.Identity(0x1234);
   EXPECT_EQ(group.Identity(), 0x1234);
 
-}
\ No newline at end of file
+}
+
+TEST(MetricGroup, TestUpdateSequence) {
+  MetricGroup group;
+  const uint64_t sequence = group.ReadBegin();
+  EXPECT_FALSE(group.ReadRetry(sequence));
+
+  group.BeginUpdate();
+  group.EndUpdate(1234);
+  EXPECT_TRUE(group.ReadRetry(sequence));
+  EXPECT_EQ(group.Timestamp(), 1234);
+  EXPECT_FALSE(group.ReadRetry(group.ReadBegin()));
+  EXPECT_TRUE(group.Metrics().empty());
+}
@@ -3,8 +3,11 @@
 * SPDX-License-Identifier: MIT
 */
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <limits>
+#include <sstream>
 #include <gtest/gtest.h>
 #include "metrichelper.h"
 
@@ -70,4 +73,63 @@ TEST(MetricHelper, TestDouble) {
     EXPECT_EQ(double_value, double_value2);
     std::cout << double_str << std::endl;
   }
-}
\ No newline at end of file
+}
+
+TEST(MetricHelper, TestCharConversion) {
+  NumberBuffer buffer;
+  EXPECT_EQ(NumberToChars(-123, buffer), "-123");
+  EXPECT_EQ(NumberToChars(uint64_t{18446744073709551615ULL}, buffer),
+            "18446744073709551615");
+  EXPECT_EQ(NumberToChars(0.5, buffer), "0.5");
+  EXPECT_EQ(NumberToChars(true, buffer), "1");
+
+  int64_t int_value = 0;
+  EXPECT_TRUE(CharsToNumber(" +42 rpm", int_value));
+  EXPECT_EQ(int_value, 42);
+  EXPECT_FALSE(CharsToNumber("rpm", int_value));
+  EXPECT_EQ(int_value, 42);
+
+  double double_value = 0;
+  EXPECT_TRUE(CharsToNumber("-1.25e3", double_value));
+  EXPECT_EQ(double_value, -1250.0);
+
+  constexpr double third = 1.0 / 3.0;
+  const std::string_view third_text = NumberToChars(third, buffer);
+  EXPECT_TRUE(CharsToNumber(third_text, double_value));
+  EXPECT_EQ(double_value, third);
+}
+
+TEST(MetricHelper, TestConversionSpeed) {
+  // Compares the stream and std::to_string path with the
+  // std::to_chars/std::from_chars path.
+  constexpr int kLoops = 200'000;
+  double stream_sum = 0;
+  const auto stream_start = std::chrono::steady_clock::now();
+  for (int index = 0; index < kLoops; ++index) {
+    const std::string text = std::to_string(index * 0.25);
+    std::istringstream str(text);
+    double value = 0;
+    str >> value;
+    stream_sum += value;
+  }
+  const std::chrono::duration<double, std::nano> stream_time =
+      std::chrono::steady_clock::now() - stream_start;
+
+  double chars_sum = 0;
+  const auto chars_start = std::chrono::steady_clock::now();
+  for (int index = 0; index < kLoops; ++index) {
+    NumberBuffer buffer;
+    const std::string_view text = NumberToChars(index * 0.25, buffer);
+    double value = 0;
+    EXPECT_TRUE(CharsToNumber(text, value));
+    chars_sum += value;
+  }
+  const std::chrono::duration<double, std::nano> chars_time =
+      std::chrono::steady_clock::now() - chars_start;
+
+  EXPECT_EQ(stream_sum, chars_sum);
+  std::cout << "Stream: " << stream_time.count() / kLoops << " ns/value"
+            << ", Chars: " << chars_time.count() / kLoops << " ns/value"
+            << ", Ratio: " << stream_time.count() / chars_time.count()
+            << std::endl;
+}
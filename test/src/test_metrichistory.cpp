@@ -0,0 +1,118 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metric.h"
+#include "metric/metrichistory.h"
+
+using namespace metric;
+
+TEST(MetricHistory, TestRange) {
+  MetricHistory history(10);
+  EXPECT_EQ(history.Capacity(), 10);
+  EXPECT_EQ(history.Size(), 0);
+
+  std::vector<HistorySample> sample_list;
+  EXPECT_EQ(history.Range(0, 1000, sample_list), 0);
+
+  for (uint64_t time = 1; time <= 25; ++time) {
+    history.Append(time * 10, ToNative(static_cast<int64_t>(time)));
+  }
+  EXPECT_EQ(history.Size(), 10);
+  EXPECT_EQ(history.Count(), 25);
+
+  // Only the last 10 samples (16..25) exist
+  EXPECT_EQ(history.Range(0, 1000, sample_list), 10);
+  EXPECT_EQ(sample_list.front().timestamp, 160);
+  EXPECT_EQ(sample_list.back().timestamp, 250);
+
+  EXPECT_EQ(history.Range(200, 225, sample_list), 3);
+  EXPECT_EQ(sample_list[0].Value<int>(MetricType::Int64), 20);
+  EXPECT_EQ(sample_list[2].Value<int>(MetricType::Int64), 22);
+
+  EXPECT_EQ(history.Range(251, 300, sample_list), 0);
+
+  history.Clear();
+  EXPECT_EQ(history.Size(), 0);
+}
+
+TEST(MetricHistory, TestConcurrentRead) {
+  // The value is always equal to the timestamp, so a reader detects any
+  // torn sample.
+  MetricHistory history(64);
+  std::atomic<bool> stop = false;
+  std::atomic<bool> failed = false;
+
+  std::thread reader([&] {
+    std::vector<HistorySample> sample_list;
+    sample_list.reserve(history.Capacity());
+    while (!stop) {
+      history.Range(0, UINT64_MAX, sample_list);
+      uint64_t last = 0;
+      for (const auto& sample : sample_list) {
+        if (sample.value.unsigned_value != sample.timestamp ||
+            sample.timestamp <= last) {
+          failed = true;
+        }
+        last = sample.timestamp;
+      }
+    }
+  });
+
+  for (uint64_t time = 1; time <= 1'000'000; ++time) {
+    NativeValue value;
+    value.unsigned_value = time;
+    history.Append(time, value);
+  }
+  stop = true;
+  reader.join();
+  EXPECT_FALSE(failed);
+}
+
+TEST(MetricHistory, TestMetric) {
+  Metric metric;
+  metric.DataType(MetricType::Double);
+  EXPECT_TRUE(metric.History() == nullptr);
+
+  metric.HistoryCapacity(100);
+  metric.Historical(true);
+  ASSERT_TRUE(metric.History() != nullptr);
+  EXPECT_EQ(metric.History()->Capacity(), 100);
+
+  for (uint64_t time = 1; time <= 5; ++time) {
+    metric.Timestamp(time);
+    metric.Value(static_cast<double>(time) * 1.5);
+  }
+  // Every sample is stored, also unchanged and filtered values
+  metric.Timestamp(6);
+  metric.Value(7.5);
+  metric.Deadband(10.0);
+  metric.Timestamp(7);
+  metric.Value(8.0);
+  EXPECT_DOUBLE_EQ(metric.Value<double>(), 7.5);
+
+  std::vector<HistorySample> sample_list;
+  EXPECT_EQ(metric.History()->Range(2, 7, sample_list), 6);
+  EXPECT_EQ(sample_list[0].Value<double>(metric.DataType()), 3.0);
+  EXPECT_EQ(sample_list[5].Value<double>(metric.DataType()), 8.0);
+
+  // A reader keeps its buffer when the history is disabled or replaced
+  const auto history = metric.History();
+  metric.Historical(false);
+  EXPECT_TRUE(metric.History() == nullptr);
+  EXPECT_EQ(history->Range(2, 7, sample_list), 6);
+
+  metric.Historical(true);
+  const auto old_history = metric.History();
+  metric.HistoryCapacity(10);
+  EXPECT_EQ(metric.History()->Capacity(), 10);
+  EXPECT_EQ(old_history->Capacity(), 100);
+}
@@ -0,0 +1,140 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metric.h"
+#include "metric/metricdatabase.h"
+#include "metric/metricorder.h"
+
+using namespace metric;
+
+TEST(MetricOrder, TestOrder) {
+  Metric metric1("Godzillas", 102, "Godzilla 2");
+  Metric metric2("King Kongs", 101, "King Kong 1");
+  Metric metric3("Godzillas", 102, "Godzilla 1");
+  Metric metric4("King Kongs", 101, "A King Kong");
+
+  MetricOrder order;
+  order.Add(metric1);
+  order.Add(metric2);
+  order.Add(metric3);
+  order.Add(metric4);
+  EXPECT_EQ(order.Size(), 4);
+
+  const std::vector<Metric*> name_list(order.ByName().begin(),
+                                       order.ByName().end());
+  const std::vector<Metric*> expected_names = {&metric4, &metric3, &metric1,
+                                               &metric2};
+  EXPECT_EQ(name_list, expected_names);
+
+  const std::vector<Metric*> group_list(order.ByGroup().begin(),
+                                        order.ByGroup().end());
+  const std::vector<Metric*> expected_groups = {&metric3, &metric1, &metric4,
+                                                &metric2};
+  EXPECT_EQ(group_list, expected_groups);
+
+  const auto godzillas = order.ByGroupName("Godzillas");
+  ASSERT_EQ(std::ranges::distance(godzillas), 2);
+  EXPECT_EQ(*godzillas.begin(), &metric3);
+
+  const auto king_kongs = order.ByGroupIdentity(101);
+  ASSERT_EQ(std::ranges::distance(king_kongs), 2);
+  EXPECT_EQ(*king_kongs.begin(), &metric4);
+
+  EXPECT_TRUE(order.ByGroupName("Mothras").empty());
+  EXPECT_TRUE(order.ByGroupIdentity(103).empty());
+
+  order.Remove(metric4);
+  EXPECT_EQ(order.Size(), 3);
+  EXPECT_EQ(*order.ByGroupIdentity(101).begin(), &metric2);
+  EXPECT_EQ(*order.ByName().begin(), &metric3);
+
+  order.Clear();
+  EXPECT_TRUE(order.ByName().empty());
+
+  // A group is added between the metrics of the other groups
+  order.Add(metric2);
+  order.Add(metric4);
+  std::vector<Metric*> godzilla_list = {&metric1, &metric3};
+  order.Add(godzilla_list);
+  const std::vector<Metric*> batch_list(order.ByGroup().begin(),
+                                        order.ByGroup().end());
+  EXPECT_EQ(batch_list, expected_groups);
+  const std::vector<Metric*> batch_names(order.ByName().begin(),
+                                         order.ByName().end());
+  EXPECT_EQ(batch_names, expected_names);
+  EXPECT_EQ(*order.ByGroupIdentity(102).begin(), &metric3);
+}
+
+TEST(MetricOrder, TestDatabaseViews) {
+  MetricDatabase database;
+  const auto* godzilla_group = database.CreateGroup("Godzillas", 102);
+  auto* metric1 = database.CreateMetric(*godzilla_group, "Godzilla 2");
+  auto* metric2 = database.CreateMetric(*godzilla_group, "Godzilla 1");
+  const auto* king_kong_group = database.CreateGroup("King Kongs", 101);
+  auto* metric3 = database.CreateMetric(*king_kong_group, "Baby Kong");
+
+  EXPECT_EQ(*database.ViewByName().begin(), metric3);
+  EXPECT_EQ(*database.ViewByGroup().begin(), metric2);
+  EXPECT_EQ(std::ranges::distance(database.ViewByGroupName("Godzillas")), 2);
+  EXPECT_EQ(*database.ViewByGroupIdentity(102).begin(), metric2);
+
+  database.DeleteMetric(*godzilla_group, "Godzilla 1");
+  EXPECT_EQ(std::ranges::distance(database.ViewByName()), 2);
+  EXPECT_EQ(*database.ViewByGroupIdentity(102).begin(), metric1);
+
+  const auto* metric4 = database.CreateMetric(*godzilla_group, "Godzilla 0");
+  EXPECT_EQ(*database.ViewByGroupName("Godzillas").begin(), metric4);
+  EXPECT_EQ(database.MetricsByName().size(), 3);
+}
+
+TEST(MetricOrder, TestListSpeed) {
+  constexpr size_t kMetrics = 100'000;
+  constexpr size_t kMetricsPerGroup = 50;
+  constexpr size_t kListings = 10;
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    // Unsorted input
+    const size_t number = (index * 7919) % kMetrics;
+    const auto group_index = number / kMetricsPerGroup;
+    MetricDefinition definition;
+    definition.group_name = "Frame " + std::to_string(group_index);
+    definition.group_identity = static_cast<int32_t>(group_index);
+    definition.name = "Signal " + std::to_string(number);
+    definition_list.push_back(std::move(definition));
+  }
+  MetricDatabase database;
+  database.ImportMetrics(definition_list);
+
+  size_t nof_listed = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t listing = 0; listing < kListings; ++listing) {
+    for (const Metric* metric : database.ViewByName()) {
+      if (metric != nullptr) {
+        ++nof_listed;
+      }
+    }
+  }
+  const std::chrono::duration<double, std::milli> list_time =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(nof_listed, kListings * kMetrics);
+  EXPECT_TRUE(std::ranges::is_sorted(
+      database.ViewByName(), [](const Metric* metric1, const Metric* metric2) {
+        return metric1->Name() < metric2->Name();
+      }));
+
+  std::cout << "Metrics: " << kMetrics << ", ViewByName: "
+            << list_time.count() / kListings << " ms/listing" << std::endl;
+}
@@ -3,7 +3,12 @@
 * SPDX-License-Identifier: MIT
  */
 
+#include <chrono>
 #include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -78,4 +83,138 @@ TEST(MetricProperty, TestValues) {
   EXPECT_GT(date_string.size(), 0);
   prop.Value(date_string);
   EXPECT_EQ(prop.Value<uint64_t>(), 0);
-}
\ No newline at end of file
+}
+
+TEST(MetricProperty, TestNativeValue) {
+  // A plain property fits in one cache line
+  EXPECT_LE(sizeof(MetricProperty), 64);
+
+  // A number of the property type isn't formatted until it's read as text
+  MetricProperty prop;
+  prop.DataType(MetricType::Double);
+  prop.Value(0.01);
+  EXPECT_EQ(prop.Value<double>(), 0.01);
+  EXPECT_EQ(prop.Value<int>(), 0);
+  EXPECT_EQ(prop.Value<std::string>(), "0.01");
+
+  // A copy or a type change keeps the value
+  const MetricProperty copy = prop;
+  EXPECT_EQ(copy.Value<double>(), 0.01);
+  prop.DataType(MetricType::String);
+  EXPECT_EQ(prop.Value<std::string>(), "0.01");
+  EXPECT_EQ(prop.Value<double>(), 0.01);
+
+  // A number of another type is stored as text
+  prop.DataType(MetricType::UInt32);
+  prop.Value(-1);
+  EXPECT_EQ(prop.Value<std::string>(), "-1");
+  prop.Value(std::string("Text"));
+  EXPECT_EQ(prop.Value<std::string>(), "Text");
+  prop.Value(uint32_t{7});
+  EXPECT_EQ(prop.Value<uint32_t>(), 7);
+  EXPECT_EQ(prop.Value<std::string>(), "7");
+}
+
+TEST(MetricProperty, TestPropertyList) {
+  MetricPropertyList list;
+  EXPECT_TRUE(list.empty());
+  list.Insert(MetricProperty("unit", "m"));
+  list.Insert(MetricProperty("description", "Height"));
+  list.Insert(MetricProperty("max", "100"));
+  ASSERT_EQ(list.size(), 3);
+
+  // Sorted on key
+  EXPECT_EQ(list.begin()->Key(), "description");
+  EXPECT_EQ((list.end() - 1)->Key(), "unit");
+
+  const auto* unit = list.Find("unit");
+  ASSERT_TRUE(unit != nullptr);
+  EXPECT_EQ(unit->Value<std::string>(), "m");
+
+  list.Insert(MetricProperty("unit", "km"));
+  EXPECT_EQ(list.size(), 3);
+  EXPECT_EQ(list.Find("unit")->Value<std::string>(), "km");
+
+  EXPECT_TRUE(list.Erase("max"));
+  EXPECT_FALSE(list.Erase("max"));
+  EXPECT_TRUE(list.Find("max") == nullptr);
+  EXPECT_EQ(list.size(), 2);
+}
+
+namespace {
+
+MetricProperty MakeNestedProperty(size_t nof_lists) {
+  MetricProperty property("set", std::string(64, 'x'));
+  property.DataType(MetricType::PropertySetList);
+  auto& property_array = property.PropertyArray();
+  property_array.resize(nof_lists);
+  for (size_t index = 0; index < nof_lists; ++index) {
+    property_array[index].Insert(
+        MetricProperty("name", "Signal with a long name " +
+                                   std::to_string(index)));
+    property_array[index].Insert(MetricProperty("unit", "m/s"));
+  }
+  return property;
+}
+
+}  // namespace
+
+TEST(MetricProperty, TestMove) {
+  static_assert(std::is_nothrow_move_constructible_v<MetricProperty>);
+  static_assert(std::is_nothrow_move_assignable_v<MetricProperty>);
+
+  MetricProperty source = MakeNestedProperty(10);
+  const auto* array_data = source.PropertyArray().data();
+
+  // A copy is a deep copy including the property array
+  const MetricProperty copy = source;
+  ASSERT_EQ(copy.PropertyArray().size(), 10);
+  EXPECT_NE(copy.PropertyArray().data(), array_data);
+  EXPECT_EQ(copy.PropertyArray()[9].Find("name")->Value<std::string>(),
+            "Signal with a long name 9");
+
+  // A move transfers the buffers without allocation
+  MetricProperty dest = std::move(source);
+  EXPECT_EQ(dest.Key(), "set");
+  EXPECT_EQ(dest.DataType(), MetricType::PropertySetList);
+  EXPECT_EQ(dest.PropertyArray().data(), array_data);
+  EXPECT_EQ(dest.PropertyArray().size(), 10);
+
+  MetricPropertyList list;
+  const MetricProperty& stored = list.Insert(std::move(dest));
+  EXPECT_EQ(stored.PropertyArray().data(), array_data);
+  EXPECT_EQ(list.Find("set")->PropertyArray()[0].Find("unit")
+                ->Value<std::string>(), "m/s");
+}
+
+TEST(MetricProperty, TestMoveSpeed) {
+  constexpr size_t kProperties = 10'000;
+  std::vector<MetricProperty> source_list;
+  source_list.reserve(kProperties);
+  for (size_t index = 0; index < kProperties; ++index) {
+    source_list.emplace_back(MakeNestedProperty(10));
+  }
+
+  std::vector<MetricProperty> copy_list;
+  copy_list.reserve(kProperties);
+  const auto copy_start = std::chrono::steady_clock::now();
+  for (const auto& property : source_list) {
+    copy_list.push_back(property);
+  }
+  const std::chrono::duration<double, std::micro> copy_time =
+      std::chrono::steady_clock::now() - copy_start;
+
+  std::vector<MetricProperty> move_list;
+  move_list.reserve(kProperties);
+  const auto move_start = std::chrono::steady_clock::now();
+  for (auto& property : source_list) {
+    move_list.push_back(std::move(property));
+  }
+  const std::chrono::duration<double, std::micro> move_time =
+      std::chrono::steady_clock::now() - move_start;
+
+  EXPECT_EQ(move_list.back().PropertyArray().size(), 10);
+  std::cout << "Copy: " << copy_time.count() / kProperties << " us"
+            << ", Move: " << move_time.count() / kProperties << " us"
+            << std::endl;
+}
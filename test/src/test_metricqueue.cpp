@@ -0,0 +1,104 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metric.h"
+#include "metric/metricqueue.h"
+
+using namespace metric;
+
+TEST(MetricQueue, TestDrain) {
+  MetricQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+
+  Metric metric1;
+  Metric metric2;
+  Metric metric3;
+  metric1.Queue(&queue);
+  metric2.Queue(&queue);
+  metric3.Queue(&queue);
+
+  metric1.DataType(MetricType::Int32);
+  metric2.DataType(MetricType::Int32);
+  metric1.Value(1);
+  metric2.Value(2);
+  metric1.Value(3); // Already queued
+  EXPECT_FALSE(queue.IsEmpty());
+
+  std::vector<Metric*> updated_list;
+  ASSERT_EQ(queue.Drain(updated_list), 2);
+  EXPECT_EQ(updated_list[0], &metric1);
+  EXPECT_EQ(updated_list[1], &metric2);
+  EXPECT_FALSE(metric1.IsUpdated());
+  EXPECT_TRUE(queue.IsEmpty());
+
+  EXPECT_EQ(queue.Drain(updated_list), 0);
+
+  // A detached metric is dropped and the others keep their order
+  metric1.SetUpdated();
+  metric2.SetUpdated();
+  metric2.Queue(nullptr);
+  queue.Purge();
+  EXPECT_FALSE(metric2.IsQueued());
+  metric3.SetUpdated();
+  ASSERT_EQ(queue.Drain(updated_list), 2);
+  EXPECT_EQ(updated_list[0], &metric1);
+  EXPECT_EQ(updated_list[1], &metric3);
+
+  metric3.SetUpdated();
+  metric3.Queue(nullptr);
+  EXPECT_EQ(queue.Drain(updated_list), 0);
+  EXPECT_FALSE(metric3.IsQueued());
+}
+
+TEST(MetricQueue, TestConcurrentPush) {
+  constexpr size_t kMetrics = 1'000;
+  constexpr int kWriters = 4;
+  MetricQueue queue;
+  std::vector<std::unique_ptr<Metric>> metric_list;
+  for (size_t index = 0; index < kMetrics; ++index) {
+    auto metric = std::make_unique<Metric>();
+    metric->DataType(MetricType::UInt64);
+    metric->Queue(&queue);
+    metric_list.emplace_back(std::move(metric));
+  }
+
+  std::atomic<bool> stop = false;
+  std::vector<std::thread> writer_list;
+  for (int writer = 0; writer < kWriters; ++writer) {
+    writer_list.emplace_back([&, writer] {
+      uint64_t value = 0;
+      while (!stop) {
+        for (size_t index = writer; index < kMetrics; index += kWriters) {
+          metric_list[index]->Value(++value);
+        }
+      }
+    });
+  }
+
+  std::vector<Metric*> updated_list;
+  for (int loop = 0; loop < 100; ++loop) {
+    queue.Drain(updated_list);
+    // A metric is never queued twice
+    std::ranges::sort(updated_list);
+    EXPECT_EQ(std::ranges::adjacent_find(updated_list), updated_list.end());
+  }
+  stop = true;
+  for (auto& writer : writer_list) {
+    writer.join();
+  }
+  queue.Drain(updated_list);
+  for (const auto& metric : metric_list) {
+    EXPECT_FALSE(metric->IsUpdated());
+  }
+}
@@ -0,0 +1,228 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/metricdatabase.h"
+#include "metric/metricsnapshot.h"
+
+using namespace metric;
+
+TEST(MetricSnapshot, TestChangeSet) {
+  MetricChangeSet change_set;
+  EXPECT_TRUE(change_set.Reserve(5'000));
+  change_set.Mark(3);
+  change_set.Mark(3);
+  change_set.Mark(4'999);
+  change_set.Mark(100'000); // Ignored
+
+  std::vector<uint32_t> row_list;
+  EXPECT_EQ(change_set.Drain([&](uint32_t row) { row_list.push_back(row); }),
+            2);
+  ASSERT_EQ(row_list.size(), 2);
+  EXPECT_EQ(row_list[0], 3);
+  EXPECT_EQ(row_list[1], 4'999);
+  EXPECT_EQ(change_set.Drain([](uint32_t) {}), 0);
+}
+
+TEST(MetricSnapshot, TestSnapshot) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  std::vector<Metric*> metric_list;
+  for (int index = 0; index < 200; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    metric->DataType(MetricType::Int32);
+    metric->Timestamp(1'000);
+    metric->Value(index);
+    metric_list.push_back(metric);
+  }
+
+  const auto snapshot1 = database.Snapshot();
+  ASSERT_TRUE(snapshot1);
+  EXPECT_EQ(snapshot1->Version(), 1);
+  const auto* value = snapshot1->Get(metric_list[10]->Handle());
+  ASSERT_TRUE(value != nullptr);
+  EXPECT_EQ(value->type, MetricType::Int32);
+  EXPECT_EQ(value->value.signed_value, 10);
+  EXPECT_EQ(value->timestamp, 1'000);
+  EXPECT_TRUE(value->valid);
+
+  // Nothing changed
+  EXPECT_EQ(database.Snapshot(), snapshot1);
+  metric_list[10]->Value(10);
+  metric_list[10]->Valid(true);
+  EXPECT_EQ(database.Snapshot(), snapshot1);
+
+  metric_list[10]->Timestamp(2'000);
+  metric_list[10]->Value(1'010);
+  const auto snapshot2 = database.Snapshot();
+  EXPECT_EQ(snapshot2->Version(), 2);
+  EXPECT_EQ(snapshot2->Get(metric_list[10]->Handle())->value.signed_value,
+            1'010);
+  EXPECT_EQ(snapshot2->Get(metric_list[10]->Handle())->timestamp, 2'000);
+
+  // The old snapshot is unchanged and shares the unchanged pages
+  EXPECT_EQ(snapshot1->Get(metric_list[10]->Handle())->value.signed_value, 10);
+  EXPECT_FALSE(snapshot2->IsShared(*snapshot1,
+                                   metric_list[10]->Handle().Index()));
+  EXPECT_TRUE(snapshot2->IsShared(*snapshot1,
+                                  metric_list[150]->Handle().Index()));
+
+  size_t count = 0;
+  snapshot2->ForEach([&](const SnapshotValue&) { ++count; });
+  EXPECT_EQ(count, 200);
+
+  // A deleted metric is removed by the next snapshot
+  const MetricHandle handle = metric_list[20]->Handle();
+  database.DeleteMetric(*group, "Metric 20");
+  const auto snapshot3 = database.Snapshot();
+  EXPECT_TRUE(snapshot3->Get(handle) == nullptr);
+  EXPECT_TRUE(snapshot2->Get(handle) != nullptr);
+
+  // A new metric is added by the next snapshot
+  auto* new_metric = database.CreateMetric(*group, "New Metric");
+  new_metric->Value(std::string("Hello"));
+  const auto snapshot4 = database.Snapshot();
+  const auto* text_value = snapshot4->Get(new_metric->Handle());
+  ASSERT_TRUE(text_value != nullptr);
+  EXPECT_EQ(text_value->Text(), "Hello");
+
+  // A text change is a new version and an unchanged text is shared
+  new_metric->Value(std::string("World"));
+  const auto snapshot5 = database.Snapshot();
+  EXPECT_EQ(snapshot5->Version(), snapshot4->Version() + 1);
+  EXPECT_EQ(snapshot5->Get(new_metric->Handle())->Text(), "World");
+  EXPECT_EQ(text_value->Text(), "Hello");
+  new_metric->Timestamp(3'000);
+  const auto snapshot6 = database.Snapshot();
+  EXPECT_EQ(snapshot6->Get(new_metric->Handle())->text,
+            snapshot5->Get(new_metric->Handle())->text);
+  count = 0;
+  snapshot6->ForEachChanged(snapshot5.get(),
+                            [&](const SnapshotValue&) { ++count; });
+  EXPECT_EQ(count, 1);
+}
+
+TEST(MetricSnapshot, TestConcurrentSnapshot) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  std::vector<Metric*> metric_list;
+  for (int index = 0; index < 1'000; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    metric->DataType(MetricType::Int64);
+    metric->Value(0);
+    metric_list.push_back(metric);
+  }
+
+  std::atomic<bool> stop = false;
+  std::thread writer([&] {
+    for (int64_t sample = 1; !stop; ++sample) {
+      for (auto* metric : metric_list) {
+        metric->Value(sample);
+      }
+    }
+  });
+
+  bool failed = false;
+  for (int loop = 0; loop < 200; ++loop) {
+    const auto snapshot = database.Snapshot();
+    int64_t first = 0;
+    snapshot->ForEach([&](const SnapshotValue& item) {
+      first = std::max(first, item.value.signed_value);
+    });
+    // The snapshot never changes while it's read
+    int64_t second = 0;
+    snapshot->ForEach([&](const SnapshotValue& item) {
+      second = std::max(second, item.value.signed_value);
+    });
+    failed |= first != second;
+  }
+  stop = true;
+  writer.join();
+  EXPECT_FALSE(failed);
+}
+
+TEST(MetricSnapshot, TestConsistentSample) {
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  std::vector<Metric*> metric_list;
+  for (int index = 0; index < 100; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    metric->DataType(MetricType::Int64);
+    metric_list.push_back(metric);
+  }
+
+  // Each update sets the timestamp to the value
+  std::atomic<bool> stop = false;
+  std::thread writer([&] {
+    for (int64_t sample = 1; !stop; ++sample) {
+      for (auto* metric : metric_list) {
+        metric->Update(static_cast<uint64_t>(sample), MetricType::Int64,
+                       ToNative(sample));
+      }
+    }
+  });
+
+  size_t nof_torn = 0;
+  for (int loop = 0; loop < 1'000; ++loop) {
+    const auto snapshot = database.Snapshot();
+    snapshot->ForEach([&](const SnapshotValue& item) {
+      if (item.valid &&
+          item.timestamp != static_cast<uint64_t>(item.value.signed_value)) {
+        ++nof_torn;
+      }
+    });
+  }
+  stop = true;
+  writer.join();
+  EXPECT_EQ(nof_torn, 0);
+}
+
+TEST(MetricSnapshot, TestSnapshotSpeed) {
+  constexpr size_t kMetrics = 100'000;
+  MetricDatabase database;
+  const auto* group = database.CreateGroup("Group", 1);
+  std::vector<Metric*> metric_list;
+  metric_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    auto* metric = database.CreateMetric(*group,
+                                         "Metric " + std::to_string(index));
+    metric->DataType(MetricType::Double);
+    metric_list.push_back(metric);
+  }
+
+  const auto full_start = std::chrono::steady_clock::now();
+  const auto first = database.Snapshot();
+  const std::chrono::duration<double, std::micro> full_time =
+      std::chrono::steady_clock::now() - full_start;
+
+  for (size_t changes : {10, 1'000, 10'000}) {
+    for (size_t index = 0; index < changes; ++index) {
+      metric_list[(index * 7'919) % kMetrics]->Value(
+          static_cast<double>(index + changes));
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const auto snapshot = database.Snapshot();
+    const std::chrono::duration<double, std::micro> time =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_GT(snapshot->Version(), first->Version());
+    std::cout << "Metrics: " << kMetrics << ", Changes: " << changes
+              << ", Snapshot: " << time.count() << " us" << std::endl;
+  }
+  std::cout << "Metrics: " << kMetrics
+            << ", First snapshot: " << full_time.count() << " us"
+            << std::endl;
+}
@@ -0,0 +1,137 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "metric/metricvalue.h"
+
+using namespace metric;
+
+TEST(MetricValue, TestKind) {
+  EXPECT_EQ(KindOf(MetricType::Int8), ValueKind::Signed);
+  EXPECT_EQ(KindOf(MetricType::UInt64), ValueKind::Unsigned);
+  EXPECT_EQ(KindOf(MetricType::DateTime), ValueKind::Unsigned);
+  EXPECT_EQ(KindOf(MetricType::Float), ValueKind::Float);
+  EXPECT_EQ(KindOf(MetricType::Double), ValueKind::Double);
+  EXPECT_EQ(KindOf(MetricType::Boolean), ValueKind::Boolean);
+  EXPECT_EQ(KindOf(MetricType::String), ValueKind::Text);
+  EXPECT_EQ(KindOf(MetricType::Text), ValueKind::Text);
+
+  EXPECT_EQ(TypeOf<bool>(), MetricType::Boolean);
+  EXPECT_EQ(TypeOf<int8_t>(), MetricType::Int8);
+  EXPECT_EQ(TypeOf<int>(), MetricType::Int32);
+  EXPECT_EQ(TypeOf<uint16_t>(), MetricType::UInt16);
+  EXPECT_EQ(TypeOf<uint64_t>(), MetricType::UInt64);
+  EXPECT_EQ(TypeOf<float>(), MetricType::Float);
+  EXPECT_EQ(TypeOf<double>(), MetricType::Double);
+}
+
+TEST(MetricValue, TestConvert) {
+  const NativeValue int_value = ToNative(300);
+  EXPECT_EQ(FromNative<int>(int_value), 300);
+
+  const NativeValue int8_value =
+      ConvertNative(MetricType::Int32, MetricType::Int8, int_value);
+  EXPECT_EQ(int8_value.signed_value, static_cast<int8_t>(300));
+
+  const NativeValue double_value =
+      ConvertNative(MetricType::Int32, MetricType::Double, int_value);
+  EXPECT_EQ(double_value.double_value, 300.0);
+
+  const NativeValue bool_value =
+      ConvertNative(MetricType::Double, MetricType::Boolean, double_value);
+  EXPECT_TRUE(bool_value.bool_value);
+
+  EXPECT_TRUE(IsSameNative(MetricType::Int32, int_value, ToNative(300)));
+  EXPECT_FALSE(IsSameNative(MetricType::Int32, int_value, ToNative(301)));
+
+  const NativeValue nan_value =
+      ToNative(std::numeric_limits<double>::quiet_NaN());
+  EXPECT_TRUE(IsSameNative(MetricType::Double, nan_value, nan_value));
+}
+
+TEST(MetricValue, TestConvertFloating) {
+  const auto to_signed = [](MetricType type, double value) {
+    return ConvertNative(MetricType::Double, type, ToNative(value))
+        .signed_value;
+  };
+  const auto to_unsigned = [](MetricType type, double value) {
+    return ConvertNative(MetricType::Double, type, ToNative(value))
+        .unsigned_value;
+  };
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+  // Truncated towards zero inside the range
+  EXPECT_EQ(to_signed(MetricType::Int32, -2.7), -2);
+  EXPECT_EQ(to_unsigned(MetricType::UInt32, 2.7), 2);
+
+  // Negative values are 0 for unsigned types
+  EXPECT_EQ(to_unsigned(MetricType::UInt8, -1.0), 0);
+  EXPECT_EQ(to_unsigned(MetricType::UInt64, -1e30), 0);
+
+  // NaN is 0
+  EXPECT_EQ(to_signed(MetricType::Int64, kNaN), 0);
+  EXPECT_EQ(to_unsigned(MetricType::UInt16, kNaN), 0);
+  const NativeValue nan_float = ConvertNative(
+      MetricType::Float, MetricType::Int8,
+      ToNative(std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_EQ(nan_float.signed_value, 0);
+
+  // Out of range values are clamped to the type
+  EXPECT_EQ(to_signed(MetricType::Int8, 300.0), 127);
+  EXPECT_EQ(to_signed(MetricType::Int8, -300.0), -128);
+  EXPECT_EQ(to_signed(MetricType::Int32, 1e10),
+            std::numeric_limits<int32_t>::max());
+  EXPECT_EQ(to_signed(MetricType::Int64, 1e19),
+            std::numeric_limits<int64_t>::max());
+  EXPECT_EQ(to_signed(MetricType::Int64, -kInfinity),
+            std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(to_unsigned(MetricType::UInt8, 1e12), 255);
+  EXPECT_EQ(to_unsigned(MetricType::UInt64, 1e20),
+            std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(to_unsigned(MetricType::UInt64, kInfinity),
+            std::numeric_limits<uint64_t>::max());
+}
+
+TEST(MetricValue, TestText) {
+  constexpr float float_value = 1.0F / 3;
+  const std::string float_text =
+      NativeToString(MetricType::Float, ToNative(float_value));
+  NativeValue float_native;
+  EXPECT_TRUE(StringToNative(MetricType::Float, float_text, float_native));
+  EXPECT_EQ(float_native.float_value, float_value);
+
+  NativeValue unit_value;
+  EXPECT_TRUE(StringToNative(MetricType::Double, " 23.5 degC", unit_value));
+  EXPECT_EQ(unit_value.double_value, 23.5);
+
+  NativeValue int_value;
+  EXPECT_TRUE(StringToNative(MetricType::Int16, "-99", int_value));
+  EXPECT_EQ(int_value.signed_value, -99);
+  EXPECT_FALSE(StringToNative(MetricType::Int16, "Goofy", int_value));
+  EXPECT_EQ(int_value.signed_value, -99);
+
+  NativeValue bool_value;
+  EXPECT_TRUE(StringToNative(MetricType::Boolean, "True", bool_value));
+  EXPECT_TRUE(bool_value.bool_value);
+  EXPECT_EQ(NativeToString(MetricType::Boolean, bool_value), "1");
+}
+
+TEST(MetricValue, TestSlot) {
+  ValueSlot slot;
+  EXPECT_EQ(slot.Type(), MetricType::String);
+
+  slot.Store(MetricType::Double, ToNative(1.5));
+  MetricType type = MetricType::Unknown;
+  NativeValue value;
+  slot.Load(type, value);
+  EXPECT_EQ(type, MetricType::Double);
+  EXPECT_EQ(value.double_value, 1.5);
+  EXPECT_EQ(slot.Type(), MetricType::Double);
+}
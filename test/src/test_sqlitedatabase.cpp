@@ -0,0 +1,214 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metric/sqlitedatabase.h"
+
+using namespace metric;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string TestFile(const std::string& name) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::filesystem::remove(path.string() + suffix);
+  }
+  return path.string();
+}
+
+}  // namespace
+
+TEST(SqliteDatabase, TestSaveAndLoad) {
+  const std::string filename = TestFile("test_metric_save.db");
+  {
+    SqliteDatabase database;
+    EXPECT_EQ(database.Type(), TypeOfDatabase::Sqlite);
+    database.Filename(filename);
+    ASSERT_TRUE(database.Open());
+
+    auto* group = database.CreateGroup("Godzillas", 101);
+    group->Type(TypeOfGroup::CanMessage);
+    group->Description("Radio active monsters");
+    auto* height = database.CreateMetric(*group, "Height");
+    height->DataType(MetricType::Double);
+    height->Unit("m");
+    height->Timestamp(1234);
+    height->Value(118.5);
+    auto* name = database.CreateMetric(*group, "Name");
+    name->DataType(MetricType::String);
+    name->Value(std::string("Gojira"));
+    auto* count = database.CreateMetric(*group, "Count");
+    count->DataType(MetricType::UInt32);
+    EXPECT_TRUE(database.Save());
+  }
+
+  SqliteDatabase database;
+  database.Filename(filename);
+  ASSERT_TRUE(database.Open());
+  ASSERT_TRUE(database.Load());
+  EXPECT_EQ(database.Groups().size(), 1);
+  EXPECT_EQ(database.Metrics().size(), 3);
+
+  const auto* group = database.GetGroupByIdentity(101);
+  ASSERT_TRUE(group != nullptr);
+  EXPECT_EQ(group->Type(), TypeOfGroup::CanMessage);
+  EXPECT_EQ(group->Description(), "Radio active monsters");
+
+  const auto* height = database.GetMetricByGroupName("Godzillas", "Height");
+  ASSERT_TRUE(height != nullptr);
+  EXPECT_EQ(height->DataType(), MetricType::Double);
+  EXPECT_EQ(height->Unit(), "m");
+  EXPECT_DOUBLE_EQ(height->Value<double>(), 118.5);
+  EXPECT_EQ(height->Timestamp(), 1234);
+
+  const auto* name = database.GetMetricByGroupName("Godzillas", "Name");
+  ASSERT_TRUE(name != nullptr);
+  EXPECT_EQ(name->Value<std::string>(), "Gojira");
+
+  const auto* count = database.GetMetricByGroupName("Godzillas", "Count");
+  ASSERT_TRUE(count != nullptr);
+  EXPECT_EQ(count->DataType(), MetricType::UInt32);
+}
+
+TEST(SqliteDatabase, TestTypeMismatch) {
+  const std::string filename = TestFile("test_metric_mismatch.db");
+  {
+    SqliteDatabase database;
+    database.Filename(filename);
+    ASSERT_TRUE(database.Open());
+    auto* group = database.CreateGroup("Frame", 1);
+    auto* count = database.CreateMetric(*group, "Count");
+    count->DataType(MetricType::Int32);
+    count->Value(42);
+    auto* speed = database.CreateMetric(*group, "Speed");
+    speed->DataType(MetricType::Double);
+    speed->Value(-2.5);
+    EXPECT_TRUE(database.Save());
+  }
+
+  // The existing metrics keep their types, so the stored values are
+  // converted from the column types.
+  SqliteDatabase database;
+  database.Filename(filename);
+  ASSERT_TRUE(database.Open());
+  const auto* group = database.CreateGroup("Frame", 1);
+  auto* count = database.CreateMetric(*group, "Count");
+  count->DataType(MetricType::Double);
+  auto* speed = database.CreateMetric(*group, "Speed");
+  speed->DataType(MetricType::Int16);
+  ASSERT_TRUE(database.Load());
+
+  EXPECT_DOUBLE_EQ(count->Value<double>(), 42.0);
+  EXPECT_TRUE(count->IsValid());
+  EXPECT_EQ(speed->Value<int16_t>(), -2);
+}
+
+TEST(SqliteDatabase, TestFlush) {
+  const std::string filename = TestFile("test_metric_flush.db");
+  {
+    SqliteDatabase database;
+    database.Filename(filename);
+    database.FlushInterval(10ms);
+    EXPECT_EQ(database.FlushInterval(), 10ms);
+    database.Concurrent(true);
+    database.Enable(true);
+    ASSERT_TRUE(database.IsOperable());
+
+    auto* group = database.CreateGroup("Frame", 0x100);
+    std::vector<MetricHandle> handle_list;
+    for (int index = 0; index < 10; ++index) {
+      auto* signal = database.CreateMetric(*group,
+                                           "Signal " + std::to_string(index));
+      signal->DataType(MetricType::Int32);
+      handle_list.push_back(signal->Handle());
+    }
+    EXPECT_EQ(database.FlushValues(), 10);
+    EXPECT_EQ(database.FlushValues(), 0);
+
+    std::vector<MetricUpdate> update_list;
+    update_list.emplace_back(handle_list[3], 33, 5000);
+    update_list.emplace_back(handle_list[7], 77, 5000);
+    database.UpdateBatch(update_list);
+    EXPECT_EQ(database.FlushValues(), 2);
+
+    // The background flush writes the last change
+    update_list.clear();
+    update_list.emplace_back(handle_list[9], 99, 6000);
+    database.UpdateBatch(update_list);
+    database.Enable(false);
+    EXPECT_FALSE(database.IsOpen());
+  }
+
+  SqliteDatabase database;
+  database.Filename(filename);
+  database.Enable(true);
+  ASSERT_TRUE(database.IsOperable());
+  // The mode is kept, so there is no background flush
+  EXPECT_FALSE(database.IsConcurrent());
+  ASSERT_EQ(database.Metrics().size(), 10);
+  // The loaded values are already in the file
+  EXPECT_EQ(database.FlushValues(), 0);
+  const auto* signal3 = database.GetMetricByGroupIdentity(0x100, "Signal 3");
+  ASSERT_TRUE(signal3 != nullptr);
+  EXPECT_EQ(signal3->Value<int>(), 33);
+  EXPECT_EQ(signal3->Timestamp(), 5000);
+  const auto* signal9 = database.GetMetricByGroupIdentity(0x100, "Signal 9");
+  ASSERT_TRUE(signal9 != nullptr);
+  EXPECT_EQ(signal9->Value<int>(), 99);
+}
+
+TEST(SqliteDatabase, TestLoadSpeed) {
+  constexpr size_t kMetrics = 100'000;
+  constexpr size_t kMetricsPerGroup = 50;
+  const std::string filename = TestFile("test_metric_speed.db");
+  std::vector<MetricDefinition> definition_list;
+  definition_list.reserve(kMetrics);
+  for (size_t index = 0; index < kMetrics; ++index) {
+    const auto group_index = index / kMetricsPerGroup;
+    MetricDefinition definition;
+    definition.group_name = "Frame " + std::to_string(group_index);
+    definition.group_identity = static_cast<int32_t>(group_index);
+    definition.name = "Signal " + std::to_string(index);
+    definition.data_type = MetricType::Double;
+    definition.unit = "m/s";
+    definition_list.push_back(std::move(definition));
+  }
+
+  std::chrono::duration<double, std::milli> save_time {};
+  {
+    SqliteDatabase database;
+    database.Filename(filename);
+    ASSERT_TRUE(database.Open());
+    database.ImportMetrics(std::move(definition_list));
+    for (const auto& metric : database.Metrics()) {
+      metric->Value(1.5);
+    }
+    const auto save_start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(database.Save());
+    save_time = std::chrono::steady_clock::now() - save_start;
+  }
+
+  SqliteDatabase database;
+  database.Filename(filename);
+  const auto load_start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(database.Open());
+  ASSERT_TRUE(database.Load());
+  const std::chrono::duration<double, std::milli> load_time =
+      std::chrono::steady_clock::now() - load_start;
+  EXPECT_EQ(database.Metrics().size(), kMetrics);
+  EXPECT_EQ(database.Metrics().back()->Unit(), "m/s");
+
+  std::cout << "Metrics: " << kMetrics << ", Save: " << save_time.count()
+            << " ms, Load: " << load_time.count() << " ms" << std::endl;
+}
@@ -0,0 +1,87 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+ */
+
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "metric/metricdatabase.h"
+#include "metric/stringpool.h"
+
+using namespace metric;
+
+TEST(StringPool, TestIntern) {
+  StringPool pool;
+  EXPECT_EQ(pool.Size(), 0);
+
+  const std::string text = "Godzilla";
+  const std::string_view godzilla1 = pool.Intern(text);
+  const std::string_view godzilla2 = pool.Intern("Godzilla");
+  EXPECT_EQ(godzilla1, "Godzilla");
+  EXPECT_EQ(godzilla1.data(), godzilla2.data());
+  EXPECT_NE(godzilla1.data(), text.data());
+
+  const std::string_view king_kong = pool.Intern("King Kong");
+  EXPECT_EQ(pool.Size(), 2);
+  EXPECT_TRUE(StringPool::IsSame(godzilla1, godzilla2));
+  EXPECT_FALSE(StringPool::IsSame(godzilla1, king_kong));
+  // Only interned strings are compared
+  EXPECT_FALSE(StringPool::IsSame(godzilla1, text));
+
+  // The views are stable when the pool grows
+  for (int index = 0; index < 10'000; ++index) {
+    std::ignore = pool.Intern("Mothra " + std::to_string(index));
+  }
+  EXPECT_EQ(godzilla1, "Godzilla");
+  EXPECT_EQ(pool.Intern("Godzilla").data(), godzilla1.data());
+}
+
+TEST(StringPool, TestRelease) {
+  StringPool pool;
+  const std::string_view godzilla1 = pool.Intern("Godzilla");
+  const std::string_view godzilla2 = pool.Intern("Godzilla");
+  StringPool::Retain(godzilla1);
+  pool.Release(godzilla1);
+  pool.Release(godzilla2);
+  EXPECT_EQ(pool.Size(), 1);
+  EXPECT_EQ(godzilla1, "Godzilla");
+  pool.Release(godzilla1);
+  EXPECT_EQ(pool.Size(), 0);
+  pool.Release({});
+
+  // Dynamic names don't grow the global pool
+  const size_t global_size = StringPool::Global().Size();
+  for (int index = 0; index < 1'000; ++index) {
+    Metric metric("Mothras", index, "Mothra " + std::to_string(index));
+    metric.Unit("m");
+    EXPECT_GT(StringPool::Global().Size(), global_size);
+  }
+  EXPECT_EQ(StringPool::Global().Size(), global_size);
+}
+
+TEST(StringPool, TestDatabase) {
+  MetricDatabase database;
+  for (int group_index = 0; group_index < 10; ++group_index) {
+    const auto* group = database.CreateGroup(
+        "Godzillas " + std::to_string(group_index), group_index);
+    for (int index = 0; index < 100; ++index) {
+      auto* metric = database.CreateMetric(*group,
+                                           "Godzilla " + std::to_string(index));
+      metric->Unit("m");
+    }
+  }
+  EXPECT_EQ(database.Metrics().size(), 1'000);
+  // 10 group names and 100 metric names
+  EXPECT_EQ(database.Strings().Size(), 110);
+
+  const auto* metric1 = database.Metrics().front().get();
+  const auto* metric2 = database.Metrics().back().get();
+  const auto unit1 = metric1->GetProperty("unit");
+  const auto unit2 = metric2->GetProperty("unit");
+  ASSERT_TRUE(unit1 != nullptr && unit2 != nullptr);
+  EXPECT_EQ(unit1->Key().data(), unit2->Key().data());
+  EXPECT_EQ(metric1->Properties()->begin()->Key().data(), unit1->Key().data());
+}